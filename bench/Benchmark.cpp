@@ -0,0 +1,565 @@
+// bench/Benchmark.cpp
+//
+// Scripted stress scenes for comparing renderer changes. Each scene runs a
+// fixed number of frames after a warmup, with scene time advanced by a
+// fixed step instead of the wall clock, so two runs draw exactly the same
+// frames. CPU and GPU frame times are written per frame as CSV and as a
+// per scene summary in JSON. Scenes with a check read back their last
+// frame and fail the run when it's wrong; --no-indirect and
+// --attrib-pointers select the other instancing and vertex format paths.
+
+#include <SDL3/SDL.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "imgui.h"
+#include "imgui_impl_opengl3.h"
+#include "imgui_impl_sdl3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <tracy/Tracy.hpp>
+
+#include "BatchRenderer.h"
+#include "DrawQueue.h"
+#include "FrameTimes.h"
+#include "GLResources.h"
+#include "GLState.h"
+#include "GpuProfiler.h"
+#include "InstanceRenderer.h"
+#include "Platform.h"
+#include "ProgramCache.h"
+#include "RenderTarget.h"
+#include "ShaderManager.h"
+#include "VertexFormat.h"
+
+static const double kBenchStep = 1.0 / 60.0; // Scene seconds per frame, whatever the wall clock says
+static const double kBenchBudgetMs = 1000.0 / 60.0;
+static const int kChurnTextures = 32; // Re-uploaded every frame
+static const int kChurnRecreated = 4; // Of those, deleted and created again every frame
+static const int kChurnSize = 256;
+static const int kChurnMeshes = 1024; // Distinct meshes, one instance each
+static const int kChurnMeshesReplaced = 32; // Removed and added again every frame
+static const int kCheckBands = 5; // Also more than the 3 segments of the batch's streams
+
+struct BenchOptions {
+    bool headless = true; // --window shows the frames instead
+    int width = 1280;
+    int height = 720;
+    int warmup = 60;  // Frames run before measuring, not recorded
+    int frames = 600; // Measured frames per scene
+    std::string scene; // Empty runs every scene
+    bool indirect = true; // --no-indirect draws instances per mesh even on 4.3
+    bool attribPointers = false; // --attrib-pointers uses the GL 3.3 vertex format path
+    std::string csvPath = "bench_frames.csv";
+    std::string jsonPath = "bench_summary.json";
+};
+
+// Renderers and resources the scenes draw with
+struct BenchContext {
+    BatchRenderer batch;
+    DrawQueue queue;
+    InstanceRenderer instances;
+    size_t rectMesh = 0;
+    size_t circleMesh = 0;
+    TextureHandle textures[kChurnTextures];
+    std::vector<size_t> meshes;
+    std::vector<uint8_t> pixels;
+};
+
+struct BenchScene {
+    const char* name;
+    void (*draw)(BenchContext& ctx, int frame, float time);
+    // Optional, reads back the last measured frame once its draws are issued
+    bool (*check)(BenchContext& ctx) = nullptr;
+};
+
+struct BenchResult {
+    std::string scene;
+    std::vector<float> cpuMs;
+    std::vector<float> gpuMs; // Per measured frame, negative where the GPU result was dropped
+    bool passed = true; // The scene's check, if it has one
+};
+
+BenchOptions ParseBenchOptions(int argc, char** argv);
+BenchResult RunScene(const BenchScene& scene, BenchContext& ctx, GpuProfiler& gpu, const BenchOptions& options,
+                     GLContext gl, const RenderTarget& target);
+void WriteCsv(const std::vector<BenchResult>& results, const std::string& path);
+void WriteJson(const std::vector<BenchResult>& results, const BenchOptions& options, const std::string& path);
+
+// Vertex throughput: 20k spinning quads and circles through the batch, a handful of draws.
+static void DrawTriangles(BenchContext& ctx, int, float time) {
+    const int count = 20000;
+    const int side = 142;
+    const float cell = 2.0f / side;
+    for (int i = 0; i < count; i++) {
+        glm::vec2 center(-1.0f + (i % side + 0.5f) * cell, -1.0f + (i / side + 0.5f) * cell);
+        glm::vec4 color((float)(i % side) / side, (float)(i / side) / side, 0.5f, 1.0f);
+        if (i & 1) {
+            BatchPushCircle(ctx.batch, center, cell * 0.35f, color, 12);
+        } else {
+            BatchPushRect(ctx.batch, center, glm::vec2(cell * 0.7f), time + i * 0.01f, color);
+        }
+    }
+}
+
+// Instance throughput: 100k instances of two meshes.
+static void DrawInstanced(BenchContext& ctx, int, float time) {
+    const int count = 100000;
+    const int side = 317;
+    const float cell = 2.0f / side;
+    for (int i = 0; i < count; i++) {
+        InstanceData instance;
+        glm::vec2 center(-1.0f + (i % side + 0.5f) * cell, -1.0f + (i / side + 0.5f) * cell);
+        instance.color = glm::vec4((float)(i % side) / side, (float)(i / side) / side, 0.5f, 1.0f);
+        if (i & 1) {
+            instance.transform = glm::vec4(center, glm::vec2(cell * 0.35f));
+            InstancePush(ctx.instances, ctx.circleMesh, instance);
+        } else {
+            instance.transform = glm::vec4(center, glm::vec2(cell * 0.7f));
+            instance.angle = time + i * 0.01f;
+            InstancePush(ctx.instances, ctx.rectMesh, instance);
+        }
+    }
+}
+
+// Per draw overhead: 2000 quads, each flushed as its own draw call.
+static void DrawManyCalls(BenchContext& ctx, int, float time) {
+    const int count = 2000;
+    const int side = 45;
+    const float cell = 2.0f / side;
+    for (int i = 0; i < count; i++) {
+        glm::vec2 center(-1.0f + (i % side + 0.5f) * cell, -1.0f + (i / side + 0.5f) * cell);
+        BatchPushRect(ctx.batch, center, glm::vec2(cell * 0.7f), time, glm::vec4(0.9f, 0.6f, 0.2f, 1.0f));
+        BatchFlush(ctx.batch);
+    }
+}
+
+// ImGui cost: a window full of widgets and a large table.
+static void DrawHeavyUi(BenchContext&, int frame, float time) {
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("Bench UI", nullptr, ImGuiWindowFlags_NoSavedSettings);
+    for (int i = 0; i < 200; i++) {
+        ImGui::PushID(i);
+        float value = 0.5f + 0.5f * std::sin(time + i * 0.1f);
+        ImGui::Text("Row %d, frame %d", i, frame);
+        ImGui::SameLine();
+        ImGui::SliderFloat("##value", &value, 0.0f, 1.0f);
+        ImGui::SameLine();
+        ImGui::Button("Button");
+        ImGui::PopID();
+    }
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders;
+    if (ImGui::BeginTable("Bench Table", 4, flags)) {
+        for (int row = 0; row < 500; row++) {
+            ImGui::TableNextRow();
+            for (int column = 0; column < 4; column++) {
+                ImGui::TableSetColumnIndex(column);
+                ImGui::Text("%d:%d %.3f", row, column, time * (row + column));
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+// Upload and object churn: every texture re-uploaded, a few recreated, each frame.
+static void DrawTextureChurn(BenchContext& ctx, int frame, float) {
+    const size_t bytes = (size_t)kChurnSize * kChurnSize * 4;
+    if (ctx.pixels.size() != bytes) ctx.pixels.resize(bytes);
+    for (size_t i = 0; i < bytes; i++) ctx.pixels[i] = (uint8_t)(i + frame);
+
+    for (int i = 0; i < kChurnTextures; i++) {
+        TextureHandle& texture = ctx.textures[i];
+        bool recreate = !texture || (i + frame) % (kChurnTextures / kChurnRecreated) == 0;
+        if (recreate) {
+            DestroyGLResource(texture);
+            texture = CreateGLResource<GLResourceType::Texture>("Churn");
+            SetGLResourceBytes(texture, bytes);
+            StateBindTexture(0, GL_TEXTURE_2D, GLName(texture));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kChurnSize, kChurnSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        } else {
+            StateBindTexture(0, GL_TEXTURE_2D, GLName(texture));
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kChurnSize, kChurnSize, GL_RGBA, GL_UNSIGNED_BYTE, ctx.pixels.data());
+    }
+    StateBindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+// Geometry suballocation: many small meshes drawn from the shared pool, some
+// replaced by meshes of another size every frame.
+static void DrawMeshChurn(BenchContext& ctx, int frame, float time) {
+    if (ctx.meshes.empty()) {
+        for (int i = 0; i < kChurnMeshes; i++) {
+            ctx.meshes.push_back(AddInstanceCircleMesh(ctx.instances, 3 + i % 61));
+        }
+    }
+    for (int i = 0; i < kChurnMeshesReplaced; i++) {
+        size_t& mesh = ctx.meshes[(frame * kChurnMeshesReplaced + i) % kChurnMeshes];
+        RemoveInstanceMesh(ctx.instances, mesh);
+        mesh = AddInstanceCircleMesh(ctx.instances, 3 + (frame + i * 7) % 61);
+    }
+
+    const int side = 32;
+    const float cell = 2.0f / side;
+    for (int i = 0; i < kChurnMeshes; i++) {
+        InstanceData instance;
+        glm::vec2 center(-1.0f + (i % side + 0.5f) * cell, -1.0f + (i / side + 0.5f) * cell);
+        instance.transform = glm::vec4(center, glm::vec2(cell * 0.4f));
+        instance.color = glm::vec4(0.3f, (float)(i % side) / side, (float)(i / side) / side, 1.0f);
+        instance.angle = time;
+        InstancePush(ctx.instances, ctx.meshes[i], instance);
+    }
+}
+
+static glm::vec4 BandColor(int band) {
+    return glm::vec4((band + 1) & 1, ((band + 1) >> 1) & 1, ((band + 1) >> 2) & 1, 1.0f);
+}
+
+// Queued flushes past the stream ring: bands of quads each over half a batch,
+// so every band is its own flush and the frame needs more stream segments
+// than the ring has.
+static void DrawQueueBands(BenchContext& ctx, int, float) {
+    const int columns = 320;
+    const int rows = (int)(ctx.batch.maxVertices / 4 * 5 / 8) / columns;
+    for (int band = 0; band < kCheckBands; band++) {
+        glm::vec4 color = BandColor(band);
+        for (int row = 0; row < rows; row++) {
+            // Shared edges come from the same expression, so the quads leave no cracks
+            float y0 = -1.0f + 2.0f * (band * rows + row) / (kCheckBands * rows);
+            float y1 = -1.0f + 2.0f * (band * rows + row + 1) / (kCheckBands * rows);
+            for (int column = 0; column < columns; column++) {
+                float x0 = -1.0f + 2.0f * column / columns;
+                float x1 = -1.0f + 2.0f * (column + 1) / columns;
+                BatchPushQuad(ctx.batch, {x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}, color);
+            }
+        }
+        BatchFlush(ctx.batch);
+    }
+}
+
+// Instanced rects and circles, one mesh of each per band, on whichever
+// path the instance renderer runs: indirect, per mesh, or either with
+// --attrib-pointers.
+static void DrawInstanceBands(BenchContext& ctx, int, float) {
+    const int columns = 7; // Odd, so the checked pixel is inside a rect, not on an edge
+    const float height = 2.0f / kCheckBands;
+    for (int band = 0; band < kCheckBands; band++) {
+        InstanceData instance;
+        instance.color = BandColor(band);
+        float y = -1.0f + (band + 0.5f) * height;
+        if (band & 1) {
+            instance.transform = glm::vec4(0.0f, y, height * 0.4f, height * 0.4f);
+            InstancePush(ctx.instances, ctx.circleMesh, instance);
+            continue;
+        }
+        for (int column = 0; column < columns; column++) {
+            float x = -1.0f + (column + 0.5f) * 2.0f / columns;
+            instance.transform = glm::vec4(x, y, 2.0f / columns, height);
+            InstancePush(ctx.instances, ctx.rectMesh, instance);
+        }
+    }
+}
+
+// Every band shows its own color at the center: none was overwritten or dropped.
+static bool CheckBands(BenchContext&) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    bool passed = true;
+    for (int band = 0; band < kCheckBands; band++) {
+        uint8_t pixel[4];
+        GLint x = viewport[0] + viewport[2] / 2;
+        GLint y = viewport[1] + (GLint)((band + 0.5f) * viewport[3] / kCheckBands);
+        glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        glm::vec4 expected = BandColor(band) * 255.0f;
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(pixel[c] - expected[c]) > 2.0f) passed = false;
+        }
+        if (!passed) {
+            std::cerr << "check: band " << band << " is " << (int)pixel[0] << ' ' << (int)pixel[1] << ' '
+                      << (int)pixel[2] << ", expected " << expected.r << ' ' << expected.g << ' ' << expected.b
+                      << "\n";
+            break;
+        }
+    }
+    return passed;
+}
+
+static const BenchScene kScenes[] = {
+    {"triangles", DrawTriangles},
+    {"instanced", DrawInstanced},
+    {"drawcalls", DrawManyCalls},
+    {"ui", DrawHeavyUi},
+    {"textures", DrawTextureChurn},
+    {"meshes", DrawMeshChurn},
+    {"queue", DrawQueueBands, CheckBands},
+    {"instancebands", DrawInstanceBands, CheckBands},
+};
+
+int main(int argc, char** argv) {
+
+    BenchOptions options = ParseBenchOptions(argc, argv);
+    InitSDL(options.headless);
+    SetGLAttributes();
+    GLContext gl = InitSDLGL("Dematik Bench", options.width, options.height, options.headless);
+    SDL_GL_SetSwapInterval(0); // Measure the frame, not the display
+    PrintGLInfo();
+    ImGuiIO& io = InitIMGUI(gl);
+    io.IniFilename = nullptr; // A saved layout would change what the UI scene draws
+
+    RenderTarget target;
+    if (options.headless) {
+        int w_px, h_px;
+        SDL_GetWindowSizeInPixels(gl.window, &w_px, &h_px);
+        if (!InitRenderTarget(target, w_px, h_px)) {
+            CleanupSDL(gl);
+            std::exit(-1);
+        }
+    }
+
+    ProgramCache programCache;
+    InitProgramCache(programCache, "shader_cache");
+    ShaderManager shaders;
+    InitShaderManager(shaders, "src/shaders", &programCache);
+    size_t mainShader = AddShaderProgram(shaders, "main", "vertex.glsl", "fragment.glsl");
+    size_t instancedShader = AddShaderProgram(shaders, "instanced", "vertex.glsl", "fragment.glsl",
+                                              {{"INSTANCED", ""}});
+    size_t indirectShader = 0;
+    if (GLAD_GL_VERSION_4_3) {
+        indirectShader = AddShaderProgram(shaders, "indirect", "vertex.glsl", "fragment.glsl",
+                                          {{"INSTANCED", ""}, {"INDIRECT", ""}}, "#version 430 core");
+    }
+    if (!LoadShaderPrograms(shaders)) {
+        std::exit(-1);
+    }
+
+    BenchContext ctx;
+    ForceVertexAttribPointers(options.attribPointers);
+    InitBatchRenderer(ctx.batch, GetShaderProgram(shaders, mainShader));
+    ReserveDrawQueue(ctx.queue, 4096);
+    ctx.batch.queue = &ctx.queue;
+    bool indirect = GLAD_GL_VERSION_4_3 && options.indirect;
+    InitInstanceRenderer(ctx.instances, GetShaderProgram(shaders, instancedShader), 1 << 17,
+                         indirect ? &GetShaderProgram(shaders, indirectShader) : nullptr);
+    std::cout << "Instances drawn " << (ctx.instances.indirect ? "indirect" : "per mesh") << ", vertex formats with "
+              << (options.attribPointers || !GLAD_GL_VERSION_4_3 ? "glVertexAttribPointer" : "glVertexAttribFormat")
+              << "\n";
+    ctx.rectMesh = AddInstanceRectMesh(ctx.instances);
+    ctx.circleMesh = AddInstanceCircleMesh(ctx.instances, 8);
+    GpuProfiler gpu;
+    InitGpuProfiler(gpu);
+
+    std::vector<BenchResult> results;
+    for (const BenchScene& scene : kScenes) {
+        if (!options.scene.empty() && options.scene != scene.name) continue;
+        results.push_back(RunScene(scene, ctx, gpu, options, gl, target));
+
+        FrameTimeSummary cpu = SummarizeFrameTimeSamples(results.back().cpuMs.data(), results.back().cpuMs.size(),
+                                                         kBenchBudgetMs);
+        std::cout << scene.name << " CPU: ";
+        PrintFrameTimes(cpu);
+        if (!results.back().passed) std::cerr << scene.name << ": check failed\n";
+    }
+    if (results.empty()) {
+        std::cerr << "No scene named '" << options.scene << "'\n";
+    } else {
+        WriteCsv(results, options.csvPath);
+        WriteJson(results, options, options.jsonPath);
+    }
+
+    PrintGeometryPoolStats(ctx.instances.geometry);
+    PrintVertexFormatStats();
+    CleanupImgui();
+    for (TextureHandle& texture : ctx.textures) DestroyGLResource(texture);
+    CleanupBatchRenderer(ctx.batch);
+    CleanupInstanceRenderer(ctx.instances);
+    CleanupGpuProfiler(gpu);
+    CleanupRenderTarget(target);
+    CleanupShaderManager(shaders);
+    CleanupVertexFormats();
+    PrintGLResourceStats();
+    CleanupGLResources();
+    CleanupSDL(gl);
+
+    bool passed = !results.empty();
+    for (const BenchResult& r : results) passed = passed && r.passed;
+    return passed ? 0 : 1;
+}
+
+BenchOptions ParseBenchOptions(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--window") {
+            options.headless = false;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--no-indirect") {
+            options.indirect = false;
+        } else if (arg == "--attrib-pointers") {
+            options.attribPointers = true;
+        } else if (arg == "--scene" && i + 1 < argc) {
+            options.scene = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--size" && i + 2 < argc) {
+            options.width = std::atoi(argv[++i]);
+            options.height = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Ignoring unknown argument '" << arg << "'\n";
+        }
+    }
+    return options;
+}
+
+BenchResult RunScene(const BenchScene& scene, BenchContext& ctx, GpuProfiler& gpu, const BenchOptions& options,
+                     GLContext gl, const RenderTarget& target) {
+    BenchResult result;
+    result.scene = scene.name;
+    result.cpuMs.reserve(options.frames);
+    result.gpuMs.assign(options.frames, -1.0f);
+
+    // After the measured frames, a few empty ones read back the last GPU results
+    const int measureEnd = options.warmup + options.frames;
+    const int total = measureEnd + kGpuProfilerLatency;
+    ImGuiIO& io = ImGui::GetIO();
+    auto tFrame = std::chrono::high_resolution_clock::now();
+    for (int frame = 0; frame < total; frame++) {
+        SDL_Event ev;
+        while (SDL_PollEvent(&ev)) {
+            ImGui_ImplSDL3_ProcessEvent(&ev);
+        }
+        if (frame == measureEnd) glFinish(); // So none of the measured frames are dropped
+
+        uint32_t resolved = gpu.resolved;
+        BeginGpuFrame(gpu);
+        int owner = frame - kGpuProfilerLatency; // Frame the resolved timings belong to
+        if (gpu.resolved != resolved && owner >= options.warmup && owner < measureEnd) {
+            result.gpuMs[owner - options.warmup] = (float)GpuFrameMs(gpu);
+        }
+
+        if (frame < measureEnd) {
+            float time = (float)(frame * kBenchStep);
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplSDL3_NewFrame();
+            io.DeltaTime = (float)kBenchStep; // The backend set it from the wall clock
+            ImGui::NewFrame();
+
+            if (options.headless) {
+                BindRenderTarget(target);
+            } else {
+                int w_px, h_px;
+                SDL_GetWindowSizeInPixels(gl.window, &w_px, &h_px);
+                StateBindFramebuffer(GL_FRAMEBUFFER, 0);
+                StateViewport(0, 0, w_px, h_px);
+            }
+            glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            InstanceBegin(ctx.instances);
+            BatchBegin(ctx.batch);
+            scene.draw(ctx, frame, time);
+            InstanceEnd(ctx.instances);
+            BatchEnd(ctx.batch);
+            ExecuteDrawQueue(ctx.queue);
+            BatchFenceFrame(ctx.batch);
+            if (scene.check && frame == measureEnd - 1) result.passed = scene.check(ctx);
+
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+        EndGpuFrame(gpu);
+        if (options.headless) {
+            glFlush();
+        } else {
+            SDL_GL_SwapWindow(gl.window);
+        }
+        EndGLResourceFrame();
+        FrameMark;
+
+        auto now = std::chrono::high_resolution_clock::now();
+        if (frame >= options.warmup && frame < measureEnd) {
+            result.cpuMs.push_back(std::chrono::duration<float, std::milli>(now - tFrame).count());
+        }
+        tFrame = now;
+    }
+    return result;
+}
+
+void WriteCsv(const std::vector<BenchResult>& results, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write " << path << "\n";
+        return;
+    }
+    out << std::fixed << std::setprecision(4) << "scene,frame,cpu_ms,gpu_ms\n";
+    for (const BenchResult& r : results) {
+        for (size_t i = 0; i < r.cpuMs.size(); i++) {
+            out << r.scene << ',' << i << ',' << r.cpuMs[i] << ',';
+            if (r.gpuMs[i] >= 0.0f) out << r.gpuMs[i]; // Empty for dropped frames
+            out << '\n';
+        }
+    }
+    std::cout << "Wrote " << path << "\n";
+}
+
+// JSON strings from the driver, escaped just enough to stay valid.
+static std::string JsonString(const char* s) {
+    std::string escaped = "\"";
+    for (; s && *s; s++) {
+        if (*s == '"' || *s == '\\') escaped += '\\';
+        if ((unsigned char)*s >= 0x20) escaped += *s;
+    }
+    return escaped + "\"";
+}
+
+static void WriteJsonSummary(std::ofstream& out, const FrameTimeSummary& s) {
+    out << "{\"frames\": " << s.frames << ", \"avg\": " << s.avgMs << ", \"p50\": " << s.p50Ms
+        << ", \"p95\": " << s.p95Ms << ", \"p99\": " << s.p99Ms << ", \"max\": " << s.maxMs
+        << ", \"over_budget\": " << s.overBudget << "}";
+}
+
+void WriteJson(const std::vector<BenchResult>& results, const BenchOptions& options, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write " << path << "\n";
+        return;
+    }
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"renderer\": " << JsonString((const char*)glGetString(GL_RENDERER)) << ",\n";
+    out << "  \"version\": " << JsonString((const char*)glGetString(GL_VERSION)) << ",\n";
+    out << "  \"headless\": " << (options.headless ? "true" : "false") << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"step_ms\": " << kBenchStep * 1000.0 << ",\n";
+    out << "  \"budget_ms\": " << kBenchBudgetMs << ",\n";
+    out << "  \"scenes\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        std::vector<float> gpu;
+        for (float ms : r.gpuMs) {
+            if (ms >= 0.0f) gpu.push_back(ms);
+        }
+        out << "    {\"name\": \"" << r.scene << "\",\n     \"cpu\": ";
+        WriteJsonSummary(out, SummarizeFrameTimeSamples(r.cpuMs.data(), r.cpuMs.size(), kBenchBudgetMs));
+        out << ",\n     \"gpu\": ";
+        WriteJsonSummary(out, SummarizeFrameTimeSamples(gpu.data(), gpu.size(), kBenchBudgetMs));
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    std::cout << "Wrote " << path << "\n";
+}
@@ -0,0 +1,68 @@
+// include/AllocTracker.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <tracy/Tracy.hpp>
+
+/*
+* Heap allocation tracking. The global operator new and delete are
+* replaced, and ImGui's allocator is pointed at TrackedAlloc/TrackedFree,
+* so every heap allocation of the program goes through here. Each one is
+* counted for the current frame and for the innermost AllocScope of the
+* calling thread, and forwarded to Tracy's memory profiler.
+*
+* Zones are opened with AllocZoneScopedN, which is ZoneScopedN plus an
+* AllocScope of the same name. Names must be string literals: they are
+* matched by pointer.
+*
+* EndAllocFrame closes a frame's counts. With the check on, every frame
+* after the warm up that allocated anything is reported with the zones
+* that did it, so the steady state loop can be held at zero.
+*
+* Counting takes a few relaxed atomic adds per allocation. Allocations
+* made outside a zone count towards the frame only.
+*/
+static const int kAllocMaxZones = 64;
+
+struct AllocFrameStats {
+    uint64_t frame = 0;
+    uint32_t allocations = 0;
+    uint32_t frees = 0;
+    uint64_t bytes = 0; // Allocated
+};
+
+struct AllocTotals {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+    uint64_t flaggedFrames = 0; // Frames after the warm up that allocated
+};
+
+// Returns the zone that was current, to hand back to PopAllocZone.
+int PushAllocZone(const char* name);
+void PopAllocZone(int previous);
+
+// Pushes on construction and pops on destruction.
+struct AllocScope {
+    explicit AllocScope(const char* name) : previous(PushAllocZone(name)) {}
+    ~AllocScope() { PopAllocZone(previous); }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    int previous;
+};
+
+#define AllocZoneScopedN(name) ZoneScopedN(name); AllocScope allocScope_(name)
+
+// Reports frames with allocations once warmupFrames frames have ended.
+void SetAllocCheck(bool enabled, int warmupFrames);
+// Closes the current frame's counts, and reports it if the check is on.
+AllocFrameStats EndAllocFrame();
+AllocTotals GetAllocTotals();
+void PrintAllocStats();
+
+// malloc/free with tracking, in the shape ImGui::SetAllocatorFunctions takes.
+void* TrackedAlloc(size_t size, void* user = nullptr);
+void TrackedFree(void* ptr, void* user = nullptr);
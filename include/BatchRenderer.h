@@ -0,0 +1,89 @@
+// include/BatchRenderer.h
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "DrawQueue.h"
+#include "GLResources.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "VertexFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Batched 2D primitive renderer. Shapes are collected into CPU side vertex
+* and index arrays during the frame and copied into a pair of StreamBuffer
+* rings, so uploads never reallocate or stall on the driver. A flush only
+* happens when the batch is full or at the end of the frame, so thousands of
+* shapes cost a handful of draw calls.
+*
+* Vertex colors are stored as normalized RGBA8, which halves the vertex size;
+* they are clamped to [0, 1] on the way in.
+*/
+struct BatchVertex {
+    glm::vec2 pos;
+    uint32_t color; // glm::packUnorm4x8, read as vec4 aColor
+};
+
+struct BatchStats {
+    uint32_t drawCalls = 0;
+    uint32_t shapes = 0;
+    uint32_t vertices = 0;
+    uint32_t indices = 0;
+    uint32_t queueSplits = 0; // Queue executed early to make room in the streams
+};
+
+struct BatchRenderer {
+    const ShaderProgram* shader = nullptr;
+    GLuint program = 0; // Program uViewProj was resolved against
+    GLuint vao = 0; // Owned by the vertex format cache
+    StreamBuffer vertexStream;
+    StreamBuffer indexStream;
+    UniformHandle<glm::mat4> uViewProj;
+
+    size_t maxVertices = 0;
+    size_t maxIndices = 0;
+    std::vector<BatchVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    glm::mat4 viewProj = glm::mat4(1.0f);
+    BatchStats stats;
+
+    // When set, flushes are submitted here instead of drawn right away.
+    // A flush that doesn't fit the streams' current segments executes the
+    // queue first, so a frame bigger than one segment is drawn (and sorted)
+    // in parts.
+    DrawQueue* queue = nullptr;
+    uint32_t layer = 0; // Sort key layer for queued flushes
+};
+
+// program must have aPos at location 0, aColor at location 1 and a mat4 uViewProj.
+// It is referenced, not copied, so a hot-reloaded program is picked up on the next flush.
+void InitBatchRenderer(BatchRenderer& r, const ShaderProgram& program, size_t maxVertices = 1 << 18);
+void CleanupBatchRenderer(BatchRenderer& r);
+// aPos and aColor in binding 0.
+VertexFormat BatchVertexFormat();
+
+// Starts a new frame: resets the stats and sets the transform for all shapes.
+// The transform is program state, so with a queue it must stay the same
+// until the queue has been executed.
+void BatchBegin(BatchRenderer& r, const glm::mat4& viewProj = glm::mat4(1.0f));
+// Uploads everything pushed since the last flush and draws or queues it.
+void BatchFlush(BatchRenderer& r);
+// Flushes. Without a queue this also fences the frame's stream segments.
+void BatchEnd(BatchRenderer& r);
+// Fences the frame's stream segments. With a queue, call this after the
+// queue has been executed so the fence covers the queued draws.
+void BatchFenceFrame(BatchRenderer& r);
+
+void BatchPushTriangle(BatchRenderer& r, glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec4 color);
+// Corners in counter clockwise order.
+void BatchPushQuad(BatchRenderer& r, glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, glm::vec4 color);
+void BatchPushRect(BatchRenderer& r, glm::vec2 center, glm::vec2 size, float angle, glm::vec4 color);
+void BatchPushCircle(BatchRenderer& r, glm::vec2 center, float radius, glm::vec4 color, int segments = 24);
+// Convex polygon, drawn as a triangle fan around points[0].
+void BatchPushPolygon(BatchRenderer& r, const glm::vec2* points, size_t count, glm::vec4 color);
@@ -0,0 +1,77 @@
+// include/DrawQueue.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Deferred draw queue. Every submission carries a packed 64-bit sort key;
+* ExecuteDrawQueue radix sorts the keys and then issues the draws through
+* the GL state cache, so draws sharing a program or texture end up next to
+* each other and the redundant binds get elided.
+*
+* Key layout, most significant first:
+*   layer 8 | program 12 | material 20 | depth 24
+* The sort is stable, so draws with equal keys keep their submission order.
+* That is what keeps overlapping 2D shapes in painter's order.
+*/
+static const int kDrawKeyLayerBits = 8;
+static const int kDrawKeyProgramBits = 12;
+static const int kDrawKeyMaterialBits = 20;
+static const int kDrawKeyDepthBits = 24;
+
+// Fields are masked to their width.
+inline uint64_t MakeDrawKey(uint32_t layer, uint32_t program, uint32_t material, uint32_t depth) {
+    uint64_t key = layer & ((1u << kDrawKeyLayerBits) - 1);
+    key = (key << kDrawKeyProgramBits) | (program & ((1u << kDrawKeyProgramBits) - 1));
+    key = (key << kDrawKeyMaterialBits) | (material & ((1u << kDrawKeyMaterialBits) - 1));
+    key = (key << kDrawKeyDepthBits) | (depth & ((1u << kDrawKeyDepthBits) - 1));
+    return key;
+}
+
+// depth in [0, 1]. Opaque draws sort front to back, blended ones back to front.
+inline uint32_t DrawKeyDepth(float depth, bool backToFront) {
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    uint32_t d = (uint32_t)(depth * ((1u << kDrawKeyDepthBits) - 1));
+    return backToFront ? ((1u << kDrawKeyDepthBits) - 1) - d : d;
+}
+
+struct DrawCommand {
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint texture = 0; // GL_TEXTURE_2D on unit 0, 0 leaves the binding alone
+    GLenum mode = GL_TRIANGLES;
+    GLsizei count = 0;
+    GLenum indexType = 0;   // 0 for glDrawArrays
+    size_t first = 0;       // First vertex, or byte offset into the element buffer
+    GLint baseVertex = 0;   // Indexed draws only
+    GLsizei instances = 1;
+};
+
+struct DrawQueueStats {
+    uint32_t submitted = 0;
+    uint32_t programSwitches = 0;
+    uint32_t textureSwitches = 0;
+    double sortMs = 0.0;
+};
+
+struct DrawQueue {
+    std::vector<DrawCommand> commands;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;   // Sorted command indices
+    std::vector<uint64_t> scratchKeys;
+    std::vector<uint32_t> scratchOrder;
+    DrawQueueStats stats;
+};
+
+void ReserveDrawQueue(DrawQueue& q, size_t count);
+void SubmitDraw(DrawQueue& q, uint64_t key, const DrawCommand& cmd);
+// Sorts, issues every draw and clears the queue.
+void ExecuteDrawQueue(DrawQueue& q);
+// Sort only, for callers that want to walk q.order themselves.
+void SortDrawQueue(DrawQueue& q);
+void ClearDrawQueue(DrawQueue& q);
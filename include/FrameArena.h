@@ -0,0 +1,69 @@
+// include/FrameArena.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Linear arena for transient frame data. Allocation bumps an offset,
+* nothing is freed on its own, and ResetArena drops everything at once
+* when the frame is done with it.
+*
+* Give each frame in flight its own arena: the main thread resets and
+* fills the one for frame N+1 while the render thread still reads frame
+* N's. With the render thread that means one per frame packet.
+*
+* When a frame needs more than the block holds, the rest comes from the
+* heap in overflow blocks. At the next reset those are freed and the block
+* grows to the high-water mark, so after a frame or two of warm up the
+* arena doesn't touch the heap at all.
+*
+* With poisoning on (the default in debug builds) reset fills everything
+* the frame used with kArenaPoisonByte, overflow blocks included, and a
+* grown block starts out filled with it, so reads of last frame's data
+* stand out. ArenaFree fills the space it gives back.
+*/
+static const size_t kArenaDefaultAlign = alignof(std::max_align_t);
+static const uint8_t kArenaPoisonByte = 0xDD;
+
+struct ArenaStats {
+    size_t used = 0;          // This frame, overflow included
+    size_t highWater = 0;     // Most used by any frame since InitArena
+    uint32_t allocations = 0; // This frame
+    uint32_t overflows = 0;   // Heap blocks this frame
+    uint32_t grows = 0;       // Times the block was reallocated bigger
+};
+
+struct ArenaOverflow; // Heap block header, list freed at reset
+
+struct LinearArena {
+    const char* name = "Arena";
+    uint8_t* base = nullptr;
+    size_t capacity = 0;
+    size_t offset = 0;
+    size_t lastOffset = 0; // Start of the latest allocation, the one ArenaFree can give back
+    ArenaOverflow* overflow = nullptr;
+    size_t overflowBytes = 0;
+#ifdef NDEBUG
+    bool poison = false;
+#else
+    bool poison = true;
+#endif
+    ArenaStats stats;
+};
+
+void InitArena(LinearArena& arena, const char* name, size_t capacity);
+void CleanupArena(LinearArena& arena);
+// Never fails; align must be a power of two.
+void* ArenaAlloc(LinearArena& arena, size_t size, size_t align = kArenaDefaultAlign);
+// Frees ptr's space only if it is the latest allocation, otherwise a no-op.
+void ArenaFree(LinearArena& arena, void* ptr, size_t size);
+// Invalidates everything allocated since the last reset.
+void ResetArena(LinearArena& arena);
+void PrintArenaStats(const LinearArena& arena);
+
+// Uninitialized; fine for the trivially constructible data frames are made of.
+template <typename T>
+T* ArenaAllocArray(LinearArena& arena, size_t count) {
+    return (T*)ArenaAlloc(arena, count * sizeof(T), alignof(T));
+}
@@ -0,0 +1,85 @@
+// include/FramePacer.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include "FrameTimes.h"
+
+#include <cstdint>
+
+/*
+* Decides when a frame starts. The modes:
+*   Vsync          swap interval 1
+*   AdaptiveVsync  swap interval -1: late frames tear instead of waiting a
+*                  whole refresh. Falls back to Vsync where unsupported.
+*   Uncapped       swap interval 0
+*   Limited        swap interval 0 and a frame rate cap: sleep until just
+*                  before the deadline, then spin the rest, since sleeps
+*                  overshoot by a scheduler tick
+*
+* Whatever the mode, at most maxFramesInFlight frames may be queued on the
+* GPU. Each frame gets a fence after its swap, and PacerBeginFrame waits on
+* the oldest one before input is sampled. Drivers otherwise let the CPU run
+* two or three frames ahead, and every queued frame is a frame of input lag.
+* Frames that were sampled but not swapped yet, such as a packet waiting on
+* a render thread, are passed in as queued and count against the cap too.
+*
+* Latency is measured from input sampling (PacerBeginFrame, just before
+* events are polled) to the frame's fence signaling, i.e. the GPU having
+* finished the frame including the swap. Scanout adds up to a refresh on
+* top, which can't be seen from GL. Fences are polled once a frame, so
+* unless the cap made us wait on it a sample is rounded up to the next
+* frame start (the Limited mode catches them while it sleeps).
+*/
+enum class PacingMode { Vsync, AdaptiveVsync, Uncapped, Limited, Count };
+
+static const int kFramePacerMaxFences = 8; // Frames in flight tracked, and the highest cap
+static const int kPacingModes = (int)PacingMode::Count;
+
+struct PacedFrame {
+    GLsync fence = nullptr;
+    uint64_t sampled = 0; // Performance counter at input sampling
+    PacingMode mode = PacingMode::Vsync;
+};
+
+struct FramePacer {
+    PacingMode mode = PacingMode::Vsync; // In effect, after any fallback
+    bool adaptiveSupported = true; // Cleared the first time swap interval -1 is refused
+    double targetFps = 120.0; // Limited
+    double spinMs = 2.0; // Limited: the last stretch before the deadline is spun, not slept
+    int maxFramesInFlight = 2; // 0 leaves it to the driver
+
+    uint64_t frequency = 0; // Performance counter ticks per second
+    uint64_t deadline = 0; // Limited: when the next frame may start
+    uint64_t sampled = 0; // This frame's input sampling time
+    PacedFrame frames[kFramePacerMaxFences]; // In flight, oldest at head
+    int head = 0;
+    int count = 0;
+
+    FrameTimeRing latency[kPacingModes]; // Input to GPU done, per mode
+    double lastLatencyMs = 0.0;
+    uint64_t capWaits = 0; // Frames that blocked on maxFramesInFlight
+};
+
+const char* PacingModeName(PacingMode mode);
+// Accepts "vsync", "adaptive", "uncapped" and "limited". Returns false otherwise.
+bool ParsePacingMode(const char* name, PacingMode& mode);
+
+// refreshRate is the display's, latency over one refresh counts as over budget.
+void InitFramePacer(FramePacer& p, PacingMode mode, double refreshRate);
+// Waits for every frame in flight and deletes the fences.
+void CleanupFramePacer(FramePacer& p);
+
+// Sets the swap interval for mode. Returns false if adaptive vsync was
+// refused and Vsync is used instead.
+bool SetPacingMode(FramePacer& p, PacingMode mode);
+
+// Call before polling input: applies the limiter and the frames in flight
+// cap, then marks the input sampling time. queued frames were sampled but
+// not swapped yet; the cap never drops below one frame for them.
+void PacerBeginFrame(FramePacer& p, int queued = 0);
+// Call right after the swap. sampled is the frame's input sampling time
+// when input was read on another thread, 0 uses PacerBeginFrame's.
+void PacerEndFrame(FramePacer& p, uint64_t sampled = 0);
+
+void PrintPacingStats(const FramePacer& p);
@@ -0,0 +1,54 @@
+// include/FrameTimes.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Recent frame times and the statistics that show stutter, which an
+* averaged FPS counter hides: percentiles, max, a histogram and the number
+* of frames that missed the budget.
+*
+* The ring is single producer, lock free: PushFrameTime stores the sample
+* and then publishes it with a release increment of count, so any thread
+* can summarize while the frame loop keeps pushing. A reader that falls a
+* whole ring behind can see a few samples from the next lap; for
+* statistics over hundreds of frames that doesn't matter.
+*/
+static const int kFrameTimeCapacity = 1024; // Power of two
+static const int kFrameTimeBuckets = 32;
+
+struct FrameTimeRing {
+    std::atomic<float> samples[kFrameTimeCapacity] = {};
+    std::atomic<uint64_t> count{0}; // Samples ever pushed
+    std::atomic<uint64_t> overBudget{0}; // Ever, not just what the ring holds
+    double budgetMs = 1000.0 / 60.0;
+};
+
+struct FrameTimeSummary {
+    uint32_t frames = 0; // Samples the numbers below cover
+    double avgMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double budgetMs = 0.0;
+    uint32_t overBudget = 0; // Within the window
+    uint64_t overBudgetTotal = 0;
+    // Bucket i holds [i, i + 1) * bucketMs, the last one everything above.
+    // Buckets are an eighth of the budget, so the histogram spans four budgets.
+    double bucketMs = 0.0;
+    uint32_t histogram[kFrameTimeBuckets] = {};
+};
+
+void ResetFrameTimes(FrameTimeRing& ring, double budgetMs);
+void PushFrameTime(FrameTimeRing& ring, double ms);
+
+// Statistics over the last window samples (at most kFrameTimeCapacity).
+FrameTimeSummary SummarizeFrameTimes(const FrameTimeRing& ring, int window = kFrameTimeCapacity);
+// Statistics over a whole recorded run, any length. Allocates a sorted copy.
+FrameTimeSummary SummarizeFrameTimeSamples(const float* samples, size_t count, double budgetMs);
+// Copies up to max of the most recent samples, oldest first. Returns how many.
+size_t CopyFrameTimes(const FrameTimeRing& ring, float* out, size_t max);
+void PrintFrameTimes(const FrameTimeSummary& s);
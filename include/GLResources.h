@@ -0,0 +1,129 @@
+// include/GLResources.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Generational handle pools for GL objects. Code holds a typed handle
+* (BufferHandle, TextureHandle, ...) instead of the raw name, and looks
+* the name up with GLName when it binds. A handle is a slot index plus the
+* slot's generation; destroying bumps the generation, so a handle kept
+* past DestroyGLResource resolves to 0 and is counted and reported as
+* stale instead of silently hitting whatever object reuses the name.
+*
+* Each type has its own pool. Slots come off a free list and the live
+* objects' metadata (GL name, owning slot, bytes, label) is kept densely
+* packed in parallel arrays, swap-removed on destroy, so create, destroy
+* and lookup are O(1) and walking the live objects touches only them.
+*
+* Destroyed objects aren't deleted right away: the GPU may still be
+* reading them from frames already submitted. They are queued with the
+* frame they were retired in; EndGLResourceFrame puts a fence behind the
+* frame's queue, and the GL objects are deleted once that fence has
+* passed. RetireGLName does the same for names that were never pooled.
+*
+* Like GLState, there is one set of pools, for the one GL context, and
+* only the thread that has the context current may use them.
+*/
+enum class GLResourceType : uint8_t {
+    Buffer,
+    VertexArray,
+    Texture,
+    Renderbuffer,
+    Framebuffer,
+    Program,
+    Count
+};
+
+static const int kGLResourceTypes = (int)GLResourceType::Count;
+static const int kGLHandleIndexBits = 20; // Live objects per type
+static const int kGLHandleGenerationBits = 32 - kGLHandleIndexBits; // Reuses of a slot before a handle can alias
+static const int kGLRetireFrames = 8; // Frames of retired objects waiting on their fence
+
+// Generation in the high bits, slot index in the low ones. Generations
+// start at 1, so a zero handle is never valid.
+template <GLResourceType Type>
+struct GLHandle {
+    uint32_t bits = 0;
+
+    explicit operator bool() const { return bits != 0; }
+    bool operator==(GLHandle other) const { return bits == other.bits; }
+    bool operator!=(GLHandle other) const { return bits != other.bits; }
+};
+
+typedef GLHandle<GLResourceType::Buffer> BufferHandle;
+typedef GLHandle<GLResourceType::VertexArray> VertexArrayHandle;
+typedef GLHandle<GLResourceType::Texture> TextureHandle;
+typedef GLHandle<GLResourceType::Renderbuffer> RenderbufferHandle;
+typedef GLHandle<GLResourceType::Framebuffer> FramebufferHandle;
+typedef GLHandle<GLResourceType::Program> ProgramHandle;
+
+struct GLResourceStats {
+    uint32_t live[kGLResourceTypes] = {};
+    uint64_t bytes[kGLResourceTypes] = {}; // As reported with SetGLResourceBytes
+    uint32_t retiredPending = 0; // Waiting on a fence
+    uint64_t deleted = 0;
+    uint64_t staleLookups = 0;
+    uint32_t retireStalls = 0; // Frames that waited for a fence because the retire ring was full
+};
+
+// Untyped core; use the typed wrappers below.
+uint32_t CreateGLObject(GLResourceType type, const char* label);
+uint32_t AdoptGLObject(GLResourceType type, GLuint name, const char* label);
+GLuint ResolveGLObject(GLResourceType type, uint32_t bits);
+bool IsGLObjectLive(GLResourceType type, uint32_t bits);
+void DestroyGLObject(GLResourceType type, uint32_t bits);
+void SetGLObjectBytes(GLResourceType type, uint32_t bits, uint64_t bytes);
+
+// Generates a new object: glGen*, or glCreateProgram for programs.
+template <GLResourceType Type>
+GLHandle<Type> CreateGLResource(const char* label = nullptr) {
+    return GLHandle<Type>{CreateGLObject(Type, label)};
+}
+
+// Takes ownership of a name created elsewhere, e.g. a linked program.
+template <GLResourceType Type>
+GLHandle<Type> AdoptGLResource(GLuint name, const char* label = nullptr) {
+    return GLHandle<Type>{AdoptGLObject(Type, name, label)};
+}
+
+// The GL name, 0 for null and stale handles.
+template <GLResourceType Type>
+GLuint GLName(GLHandle<Type> handle) {
+    return ResolveGLObject(Type, handle.bits);
+}
+
+template <GLResourceType Type>
+bool IsGLResourceLive(GLHandle<Type> handle) {
+    return IsGLObjectLive(Type, handle.bits);
+}
+
+// Invalidates the handle now, deletes the object once the GPU is done with
+// this frame. Null and stale handles are ignored; handle is nulled.
+template <GLResourceType Type>
+void DestroyGLResource(GLHandle<Type>& handle) {
+    DestroyGLObject(Type, handle.bits);
+    handle = GLHandle<Type>{};
+}
+
+// Memory estimate, summed per type in the stats.
+template <GLResourceType Type>
+void SetGLResourceBytes(GLHandle<Type> handle, uint64_t bytes) {
+    SetGLObjectBytes(Type, handle.bits, bytes);
+}
+
+// Deferred delete of a name that isn't in a pool.
+void RetireGLName(GLResourceType type, GLuint name);
+// Fences this frame's retired objects and deletes the ones whose fence has
+// passed. Call once per frame after the frame's commands are submitted.
+void EndGLResourceFrame();
+// Waits for the GPU, deletes everything retired and reports objects still
+// live as leaks, deleting them too. Call before the context goes away.
+void CleanupGLResources();
+
+const char* GLResourceTypeName(GLResourceType type);
+GLResourceStats GetGLResourceStats();
+void PrintGLResourceStats();
@@ -0,0 +1,50 @@
+// include/GLState.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+/*
+* Shadow copy of the GL state we touch every frame. The State* calls skip
+* the GL call when the value is already set and count issued vs elided calls.
+*
+* Everything starts out unknown, so the first call always goes through.
+* Code that changes state behind the cache's back must call InvalidateGLState
+* afterwards. The ImGui backend restores everything it changes, so it doesn't.
+* Use the StateDelete* calls so a recycled object name isn't mistaken for
+* one that is still bound.
+*/
+struct GLStateCounters {
+    uint32_t issued = 0;
+    uint32_t elided = 0;
+};
+
+void InvalidateGLState();
+
+void StateUseProgram(GLuint program);
+void StateBindVertexArray(GLuint vao);
+// GL_ELEMENT_ARRAY_BUFFER is VAO state: it's tracked for the bound VAO only.
+void StateBindBuffer(GLenum target, GLuint buffer);
+// Indexed bindings aren't cached, but glBindBufferRange also sets the generic one.
+void StateBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+void StateBindTexture(GLuint unit, GLenum target, GLuint texture);
+// GL_FRAMEBUFFER sets both the draw and the read binding.
+void StateBindFramebuffer(GLenum target, GLuint framebuffer);
+
+void StateEnable(GLenum cap, bool enabled); // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST
+void StateBlendFunc(GLenum src, GLenum dst);
+void StateBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+void StateBlendEquation(GLenum mode);
+void StateDepthFunc(GLenum func);
+void StateDepthMask(bool write);
+void StateViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+void StateDeleteProgram(GLuint program);
+void StateDeleteVertexArray(GLuint vao);
+void StateDeleteBuffer(GLuint buffer);
+void StateDeleteTexture(GLuint texture);
+void StateDeleteFramebuffer(GLuint framebuffer);
+
+const GLStateCounters& GetGLStateCounters();
+void ResetGLStateCounters();
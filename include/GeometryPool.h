@@ -0,0 +1,94 @@
+// include/GeometryPool.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLResources.h"
+#include "RangeAllocator.h"
+#include "VertexFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Static geometry of one vertex layout, suballocated from one vertex buffer
+* and one index buffer. Meshes are drawn with their baseVertex and
+* firstIndex (glDrawElementsBaseVertex and friends, or indirect commands),
+* so every mesh of the pool draws from the same buffers, and with the
+* same VertexFormat from the same cached VAO.
+*
+* Each buffer's space is handed out by a RangeAllocator, in vertices and in
+* indices, and meshes keep their indices local to the mesh. Meshes without
+* indices get sequential ones, so every draw is indexed.
+*
+* When an allocation doesn't fit, the buffer that is out of room is
+* defragmented if that leaves a quarter of it free, so a nearly full pool
+* doesn't pack again on every add, and grown otherwise. Either way a new
+* buffer is filled on the GPU with glCopyBufferSubData, the live meshes
+* packed to its front when defragmenting, and the old one is destroyed
+* through GLResources so frames in flight keep drawing from it.
+* Defragmenting moves meshes: hold on to the GeometryHandle and look up the
+* offsets with GetGeometry when drawing.
+*
+* Bind with BindGeometryPool before drawing: a replaced buffer is picked up
+* there, and the VAOs of a replaced index buffer are released with it.
+*/
+static const uint32_t kGeometryMinVertices = 1 << 12;
+static const uint32_t kGeometryMinIndices = 1 << 14;
+
+// 1-based slot in the pool's range table, 0 is null. Not generational:
+// don't use a handle after FreeGeometry.
+struct GeometryHandle {
+    uint32_t index = 0;
+
+    explicit operator bool() const { return index != 0; }
+};
+
+struct GeometryRange {
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0; // In indices; the byte offset is firstIndex * sizeof(uint32_t)
+    GLsizei indexCount = 0;
+    GLsizei vertexCount = 0;
+    uint32_t vertexNode = kRangeNone; // In the allocators, kRangeNone when the slot is free
+    uint32_t indexNode = kRangeNone;
+};
+
+struct GeometryPoolStats {
+    uint32_t grows = 0;
+    uint32_t defrags = 0;
+    uint64_t bytesUploaded = 0;
+    uint64_t bytesMoved = 0; // Copied on the GPU by grows and defrags
+};
+
+struct GeometryPool {
+    const char* name = "Geometry";
+    GLsizei stride = 0;
+    BufferHandle vertexBuffer;
+    BufferHandle indexBuffer;
+    RangeAllocator vertices;
+    RangeAllocator indices;
+    std::vector<GeometryRange> ranges;
+    std::vector<uint32_t> freeRanges;
+    std::vector<uint32_t> sequentialIndices; // Scratch for meshes without indices
+    GeometryPoolStats stats;
+};
+
+// Capacities are in vertices and indices; the buffers grow as needed.
+void InitGeometryPool(GeometryPool& pool, const char* name, GLsizei stride,
+                      uint32_t vertexCapacity = kGeometryMinVertices, uint32_t indexCapacity = kGeometryMinIndices);
+void CleanupGeometryPool(GeometryPool& pool);
+
+// vertices holds vertexCount * stride bytes. indices may be null.
+GeometryHandle AddGeometry(GeometryPool& pool, const void* vertices, uint32_t vertexCount,
+                           const uint32_t* indices, uint32_t indexCount);
+// The space is reused right away; GL orders the new upload after earlier draws.
+void FreeGeometry(GeometryPool& pool, GeometryHandle& handle);
+// Where the mesh is now. Empty for null and freed handles.
+const GeometryRange& GetGeometry(const GeometryPool& pool, GeometryHandle handle);
+// Binds the VAO for format and the pool's index buffer, with the vertex
+// buffer on binding. Other bindings of format are left to the caller.
+void BindGeometryPool(const GeometryPool& pool, const VertexFormat& format, uint32_t binding = 0);
+// Packs the live meshes to the front of both buffers.
+void DefragmentGeometryPool(GeometryPool& pool);
+void PrintGeometryPoolStats(const GeometryPool& pool);
@@ -0,0 +1,85 @@
+// include/GpuProfiler.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Built-in GPU pass timings from timer queries, no Tracy server needed.
+*
+* Every scope writes a GL_TIMESTAMP at push and at pop. A frame's queries
+* are read back kGpuProfilerLatency frames later, when the GPU is long done
+* with them, so reading never stalls. If a frame's results still aren't
+* available by then it is dropped instead of waited on.
+*
+* Timestamps are used rather than GL_TIME_ELAPSED because elapsed queries
+* can't nest, and scopes form a tree: the frame is the root and passes nest
+* inside it.
+*/
+static const int kGpuProfilerLatency = 3; // Frames of queries in flight
+static const int kGpuProfilerHistory = 120; // Frames of root timings kept for the graph
+
+struct GpuScopeRecord {
+    const char* name = nullptr; // Must outlive the frame, string literals in practice
+    int parent = -1;
+    int depth = 0;
+    int begin = 0; // Query indices into the frame's pool
+    int end = 0;
+};
+
+struct GpuFrameQueries {
+    std::vector<GLuint> queries; // Pool, grows as needed
+    std::vector<GpuScopeRecord> scopes;
+    int used = 0;
+    bool pending = false; // Recorded and not read back yet
+};
+
+struct GpuTiming {
+    std::string name;
+    int parent = -1; // Index into GpuProfiler::timings
+    int depth = 0;
+    double ms = 0.0;
+    double avgMs = 0.0; // Exponential moving average by name
+};
+
+struct GpuProfiler {
+    bool enabled = false; // False when the driver has no timestamp bits
+    GpuFrameQueries frames[kGpuProfilerLatency];
+    int frame = 0; // Slot being recorded
+    std::vector<int> stack; // Open scopes of the current frame
+
+    std::vector<GpuTiming> timings; // Latest resolved frame, in push order
+    std::unordered_map<std::string, double> averages;
+    float history[kGpuProfilerHistory] = {}; // Root ms, ring
+    int historyHead = 0; // Oldest entry
+    uint32_t dropped = 0; // Frames whose results weren't ready in time
+    uint32_t resolved = 0; // Frames read back; timings belong to kGpuProfilerLatency frames ago
+};
+
+void InitGpuProfiler(GpuProfiler& p);
+void CleanupGpuProfiler(GpuProfiler& p);
+
+// Reads back the frame recorded kGpuProfilerLatency frames ago and opens
+// the root scope. Everything up to EndGpuFrame is timed.
+void BeginGpuFrame(GpuProfiler& p, const char* name = "Frame");
+void EndGpuFrame(GpuProfiler& p);
+
+void PushGpuScope(GpuProfiler& p, const char* name);
+void PopGpuScope(GpuProfiler& p);
+
+// Root of the latest resolved frame, 0 before the first one.
+double GpuFrameMs(const GpuProfiler& p);
+
+// Pushes on construction and pops on destruction.
+struct GpuScope {
+    GpuScope(GpuProfiler& p, const char* name) : profiler(p) { PushGpuScope(profiler, name); }
+    ~GpuScope() { PopGpuScope(profiler); }
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+    GpuProfiler& profiler;
+};
@@ -0,0 +1,27 @@
+// include/Hash.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+* 64-bit FNV-1a. Used for cache keys, not for anything security related.
+* Pass a previous result as seed to hash several pieces into one key.
+*/
+static const uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = kHashSeed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Includes the terminator so ("ab", "c") and ("a", "bc") hash differently.
+inline uint64_t HashString(const std::string& s, uint64_t seed = kHashSeed) {
+    return HashBytes(s.c_str(), s.size() + 1, seed);
+}
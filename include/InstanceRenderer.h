@@ -0,0 +1,117 @@
+// include/InstanceRenderer.h
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "BatchRenderer.h"
+#include "GeometryPool.h"
+#include "GLResources.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Instanced renderer for many copies of the same mesh. Meshes are uploaded
+* once into a GeometryPool, so they all share one vertex buffer, one index
+* buffer and one cached VAO; per-instance transform, color and angle are
+* streamed every frame through a StreamBuffer and read with
+* glVertexAttribDivisor(1), so each mesh costs one
+* glDrawElementsInstancedBaseVertex call per flush however many copies are
+* pushed.
+*
+* Instance data is interleaved in one stream. The instance binding is
+* re-pointed at the frame's allocation before each draw (one
+* glBindVertexBuffer on 4.3), which works on 3.3 without base instance
+* support. Because of that, draws are issued immediately instead of going
+* through a DrawQueue.
+*
+* With GL 4.3 and an indirect program, a flush instead writes one
+* DrawElementsIndirectCommand per mesh and submits them all with a single
+* glMultiDrawElementsIndirect. The instances of all meshes go into one SSBO
+* range, and each command's baseInstance is where its instances start. The
+* shader gets its instance index from a 0..N-1 attribute stream with
+* divisor 1, which GL offsets by baseInstance (gl_BaseInstance and
+* gl_DrawID need 4.6).
+*/
+struct InstanceData {
+    glm::vec4 transform = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // xy offset, zw scale
+    glm::vec4 color = glm::vec4(1.0f); // Multiplied with the mesh's vertex colors
+    float angle = 0.0f; // Radians, applied after scale and before offset
+};
+
+struct InstanceMesh {
+    GeometryHandle geometry; // Null once removed
+    std::vector<InstanceData> instances; // Pushed since the last flush
+};
+
+// Layout fixed by GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+static const size_t kInstanceMaxIndirectDraws = 4096; // Per glMultiDrawElementsIndirect
+
+struct InstanceStats {
+    uint32_t drawCalls = 0; // GL calls, a multi-draw counts once
+    uint32_t meshDraws = 0; // Meshes drawn, what the calls would be without multi-draw
+    uint32_t instances = 0;
+};
+
+struct InstanceRenderer {
+    const ShaderProgram* shader = nullptr;
+    GLuint program = 0; // Program uViewProj was resolved against
+    UniformHandle<glm::mat4> uViewProj;
+    StreamBuffer instanceStream;
+    size_t maxInstances = 0; // Per draw call, or per multi-draw
+    GeometryPool geometry;
+    VertexFormat format; // Mesh vertices and the instance stream
+    std::vector<InstanceMesh> meshes;
+    std::vector<size_t> freeMeshes; // Removed, reused by the next add
+
+    glm::mat4 viewProj = glm::mat4(1.0f);
+    InstanceStats stats;
+
+    // Multi-draw indirect path
+    bool indirect = false;
+    const ShaderProgram* indirectShader = nullptr;
+    GLuint indirectProgram = 0;
+    UniformHandle<glm::mat4> uIndirectViewProj;
+    BufferHandle instanceIndexBuffer; // 0..maxInstances-1
+    StreamBuffer commandStream;
+    std::vector<DrawElementsIndirectCommand> commands;
+    size_t pendingInstances = 0; // Across all meshes
+    size_t storageAlignment = 4; // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+};
+
+// program is the vertex.glsl permutation built with INSTANCED defined: aPos and
+// aColor at 0 and 1, iTransform, iColor and iAngle at 2, 3 and 4, a mat4 uViewProj.
+// indirectProgram is the INSTANCED + INDIRECT permutation (GLSL 430); without
+// it, or below GL 4.3, the per-mesh instanced path is used.
+void InitInstanceRenderer(InstanceRenderer& r, const ShaderProgram& program, size_t maxInstances = 1 << 16,
+                          const ShaderProgram* indirectProgram = nullptr);
+void CleanupInstanceRenderer(InstanceRenderer& r);
+
+// Returns the mesh index used with InstancePush. indices may be null.
+size_t AddInstanceMesh(InstanceRenderer& r, const BatchVertex* vertices, size_t vertexCount,
+                       const uint32_t* indices, size_t indexCount);
+// Frees the mesh's geometry; its index may be handed out again by the next add.
+void RemoveInstanceMesh(InstanceRenderer& r, size_t mesh);
+// White unit square centered on the origin.
+size_t AddInstanceRectMesh(InstanceRenderer& r);
+// White circle of radius 1 around the origin.
+size_t AddInstanceCircleMesh(InstanceRenderer& r, int segments = 24);
+
+void InstanceBegin(InstanceRenderer& r, const glm::mat4& viewProj = glm::mat4(1.0f));
+void InstancePush(InstanceRenderer& r, size_t mesh, const InstanceData& instance);
+// Draws every mesh with pending instances.
+void InstanceFlush(InstanceRenderer& r);
+// Flushes and fences this frame's stream segment.
+void InstanceEnd(InstanceRenderer& r);
@@ -0,0 +1,109 @@
+// include/JobSystem.h
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Work stealing job scheduler on SDL threads and atomics.
+*
+* Every thread that runs jobs has a Chase-Lev deque: it pushes and pops
+* its own jobs at the bottom, LIFO, which keeps caches warm, and idle
+* threads steal from the top of other deques, FIFO, which takes the
+* oldest and usually biggest work. Pops and steals only race on the last
+* job, settled with one compare and swap.
+*
+* A JobCounter tracks a group of jobs. Waiting on it runs other jobs
+* instead of blocking, so waits can nest. Jobs can also be queued to run
+* after a counter reaches zero (RunJobsAfter); they are pushed by
+* whichever thread finishes the last job of the dependency.
+*
+* Workers default to one per logical core minus one, since the thread that
+* calls InitJobSystem works too when it waits. With pinning, worker i runs
+* on core i + 1 (Linux and Windows; elsewhere pinning is ignored).
+*
+* Only threads known to the scheduler can submit: the one that called
+* InitJobSystem, the workers and up to kJobExternalThreads threads that
+* called AttachJobThread. Anything else runs its jobs inline. Each of them
+* allocates jobs from a ring of kJobPoolSize, so at most that many of its
+* jobs may be unfinished at once.
+*/
+static const int kJobMaxWorkers = 63;
+static const int kJobExternalThreads = 4; // Besides the initializing thread
+static const int kJobDequeSize = 4096; // Power of two, jobs queued per thread
+static const int kJobPoolSize = 1024; // Power of two, unfinished jobs per thread
+
+// Runs items [begin, end). Single jobs get [0, 1).
+typedef void (*JobFn)(void* data, uint32_t begin, uint32_t end);
+
+struct JobCounter {
+    SDL_AtomicInt pending{}; // Jobs queued and not finished
+    void* continuations = nullptr; // Jobs to run at zero; null while at zero, so a zeroed counter is done
+};
+
+struct Job {
+    JobFn fn = nullptr;
+    void* data = nullptr;
+    uint32_t begin = 0;
+    uint32_t end = 1;
+    JobCounter* counter = nullptr;
+    Job* next = nullptr; // In a counter's continuation list
+};
+
+struct JobDeque {
+    SDL_AtomicInt top{}; // Stolen from here
+    SDL_AtomicInt bottom{}; // Pushed and popped here, by the owner only
+    void* jobs[kJobDequeSize] = {};
+};
+
+struct JobThreadStats {
+    uint64_t executed = 0;
+    uint64_t stolen = 0; // Of executed, taken from another thread
+    uint64_t sleeps = 0;
+};
+
+struct JobThread {
+    JobDeque deque;
+    Job pool[kJobPoolSize];
+    uint32_t poolNext = 0;
+    uint32_t random = 0; // Victim selection state
+    JobThreadStats stats; // Written by the owner only
+};
+
+struct JobSystem {
+    int workerCount = 0;
+    int threadCount = 0; // Workers + the initializing thread + kJobExternalThreads
+    SDL_AtomicInt attached{}; // External threads attached so far
+    bool pinned = false;
+    SDL_Thread* workers[kJobMaxWorkers] = {};
+    JobThread* threads = nullptr; // threadCount of them: the initializing thread, workers, attached threads
+    SDL_Semaphore* wake = nullptr;
+    SDL_AtomicInt sleeping{};
+    SDL_AtomicInt quit{};
+    JobThreadStats totals; // Summed over all threads by CleanupJobSystem
+};
+
+// workers < 0 uses SDL_GetNumLogicalCPUCores() - 1. Only one job system may exist.
+void InitJobSystem(JobSystem& js, int workers = -1, bool pin = false);
+void CleanupJobSystem(JobSystem& js);
+// Lets the calling thread submit and wait. Returns false if all slots are taken.
+bool AttachJobThread(JobSystem& js);
+
+void InitJobCounter(JobCounter& counter);
+bool JobCounterDone(JobCounter& counter);
+
+// Queues jobs on the calling thread's deque. counter may be null. Only one
+// thread should add jobs to a given counter at a time.
+void RunJobs(JobSystem& js, const Job* jobs, size_t count, JobCounter* counter);
+// Queues jobs once dependency reaches zero, right away if it already has.
+void RunJobsAfter(JobSystem& js, JobCounter& dependency, const Job* jobs, size_t count, JobCounter* counter);
+// Runs jobs until counter reaches zero.
+void WaitForCounter(JobSystem& js, JobCounter& counter);
+
+// Splits [0, count) into jobs of at least minBatch items, runs them and waits.
+void ParallelFor(JobSystem& js, uint32_t count, uint32_t minBatch, JobFn fn, void* data);
+
+// Prints the totals, so call it after CleanupJobSystem.
+void PrintJobSystemStats(const JobSystem& js);
@@ -0,0 +1,24 @@
+// include/Platform.h
+#pragma once
+
+#include <SDL3/SDL.h>
+#include "imgui.h"
+
+/*
+* Window, GL context and ImGui setup shared by the app and the benchmark.
+* Failures here are fatal: they log and exit.
+*/
+struct GLContext {
+    SDL_Window* window;
+    SDL_GLContext context;
+};
+
+void SetGLAttributes();
+// headless selects SDL's offscreen video driver, so no display is needed.
+void InitSDL(bool headless = false);
+// Headless windows are hidden and run with vsync off.
+GLContext InitSDLGL(const char* title, int width, int height, bool headless = false);
+void PrintGLInfo();
+ImGuiIO& InitIMGUI(GLContext gl);
+void CleanupImgui();
+void CleanupSDL(GLContext gl);
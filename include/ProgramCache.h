@@ -0,0 +1,45 @@
+// include/ProgramCache.h
+#pragma once
+
+#include "Shader.h"
+
+#include <cstdint>
+#include <string>
+
+/*
+* On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary,
+* GL 4.1). Entries are keyed by a hash of the shader sources, the define set
+* and the GL_RENDERER/GL_VERSION strings, so a driver update just misses.
+* A binary the driver rejects is recompiled from source and overwritten.
+*/
+struct ProgramCacheStats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t rejected = 0; // Binary on disk but the driver refused it
+    double loadMs = 0.0;    // Time spent loading cached binaries
+    double compileMs = 0.0; // Time spent compiling from source
+    double savedMs = 0.0;   // Recorded compile time of the hits minus their load time
+};
+
+struct ProgramCache {
+    std::string directory;
+    std::string driver; // GL_RENDERER + GL_VERSION, part of every key
+    bool enabled = false;
+    ProgramCacheStats stats;
+};
+
+// Disabled when the context has no program binary formats.
+void InitProgramCache(ProgramCache& cache, const char* directory);
+
+// defines is any text that changes the compiled result but isn't in the sources.
+uint64_t ProgramCacheKey(const ProgramCache& cache, const std::string& vertexSource,
+                         const std::string& fragmentSource, const std::string& defines);
+
+// Returns a linked program, or 0 if there is no entry or the driver rejects it.
+// Hits add to the load time and the time saved.
+GLuint ProgramCacheLoad(ProgramCache& cache, uint64_t key);
+// Records a miss and, when enabled, writes the binary. program must have been
+// linked with the retrievable hint.
+void ProgramCacheStore(ProgramCache& cache, uint64_t key, GLuint program, double compileMs);
+
+void PrintProgramCacheStats(const ProgramCache& cache);
@@ -0,0 +1,71 @@
+// include/RangeAllocator.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+* Offset allocator in the style of TLSF: hands out ranges of a linear space
+* (vertices of a buffer, indices, ...) without touching the space itself.
+*
+* Free ranges sit in one of kRangeBins size classes, each a doubly linked
+* list, with a bit per class saying whether it is empty. Classes are a small
+* float of the size (3 mantissa bits), so within a power of two there are 8
+* of them. A request looks in the first class whose smallest range is at
+* least the request, found with the bit masks, so allocation takes a couple
+* of bit scans and no search. Only when that finds nothing is the request's
+* own class searched for a range that is big enough, so an allocation
+* fails only when no free range fits. The range taken is split to the exact
+* size. Freeing merges the range with free physical neighbours.
+*
+* Ranges are nodes in a vector, linked to their physical neighbours; node
+* slots are recycled, so steady alloc/free churn doesn't allocate.
+*/
+static const uint32_t kRangeNone = 0xFFFFFFFFu;
+static const int kRangeBins = 256;
+static const int kRangeBinGroups = kRangeBins / 8; // One bit of topMask each
+
+struct RangeNode {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    uint32_t prevPhysical = kRangeNone;
+    uint32_t nextPhysical = kRangeNone;
+    uint32_t prevFree = kRangeNone; // Within the size class
+    uint32_t nextFree = kRangeNone;
+    bool used = false; // False for free ranges and recycled slots
+};
+
+// node identifies the range for RangeFree; kRangeNone when allocation failed.
+struct RangeAllocation {
+    uint32_t offset = 0;
+    uint32_t node = kRangeNone;
+};
+
+struct RangeAllocator {
+    uint32_t capacity = 0;
+    uint32_t freeUnits = 0;
+    uint32_t allocations = 0;
+    uint32_t tail = kRangeNone; // Physically last node, where growing appends
+    uint32_t topMask = 0;
+    uint8_t binMasks[kRangeBinGroups] = {};
+    uint32_t binHeads[kRangeBins];
+    std::vector<RangeNode> nodes;
+    std::vector<uint32_t> unusedNodes;
+};
+
+void InitRangeAllocator(RangeAllocator& a, uint32_t capacity);
+// Fails (node == kRangeNone) when no free range is size or bigger, even if
+// that much is free in total. size must be > 0.
+RangeAllocation RangeAlloc(RangeAllocator& a, uint32_t size);
+// Freeing a node that isn't allocated (twice, or never) is ignored, unless
+// the slot has been handed out again since.
+void RangeFree(RangeAllocator& a, uint32_t node);
+// Appends free space at the end, merged with a free range already there.
+void GrowRangeAllocator(RangeAllocator& a, uint32_t capacity);
+uint32_t LargestFreeRange(const RangeAllocator& a);
+// Whether packing the live ranges together would leave a quarter of the
+// space free after a size allocation; when it wouldn't, growing is better.
+bool RangePackPays(const RangeAllocator& a, uint32_t size);
+// Size class of size. Sizes below 8 are exact; above, the low bits are
+// dropped, or with roundUp rounded up to the next class.
+uint32_t RangeSizeBin(uint32_t size, bool roundUp);
@@ -0,0 +1,25 @@
+// include/RenderTarget.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLResources.h"
+
+/*
+* Offscreen framebuffer with an RGBA8 color and a depth/stencil
+* renderbuffer. Headless runs draw into one of these instead of the
+* default framebuffer, which may not exist or may never be presented.
+*/
+struct RenderTarget {
+    FramebufferHandle fbo;
+    RenderbufferHandle color;
+    RenderbufferHandle depthStencil;
+    int width = 0;
+    int height = 0;
+};
+
+// Returns false and cleans up if the framebuffer is incomplete.
+bool InitRenderTarget(RenderTarget& rt, int width, int height);
+void CleanupRenderTarget(RenderTarget& rt);
+// Binds for drawing and reading and sets the viewport to the whole target.
+void BindRenderTarget(const RenderTarget& rt);
@@ -0,0 +1,81 @@
+// include/RenderThread.h
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include "Platform.h"
+
+#include <cstdint>
+
+/*
+* Render thread fed through two frame packets. The main thread fills one
+* packet (input, UI, simulation) while the render thread submits the other,
+* so frame N+1 is built while frame N is drawn.
+*
+* A packet belongs to exactly one thread at a time: AcquirePacket hands
+* the free one to the main thread, waiting if the render thread still has
+* it, and SubmitPacket hands it to the render thread. The render thread
+* owns the GL context while it runs. Everything GL is created before
+* StartRenderThread and destroyed after StopRenderThread, on the main
+* thread.
+*
+* The render callback may write results (stats, timings) back into the
+* packet; the main thread sees them when that packet comes round again,
+* two frames later.
+*
+* Without a thread, SubmitPacket renders on the calling thread. Same
+* packets, same callback, no overlap: useful for comparing and debugging.
+*
+* SDL documents SDL_GL_MakeCurrent, SDL_GL_SwapWindow and
+* SDL_GL_SetSwapInterval as main thread only, and the render thread calls
+* all three. WGL, GLX and EGL allow it from any thread the context is
+* current on, Cocoa doesn't, so kRenderThreadSupported is false on Apple
+* platforms and the app renders on the main thread there by default.
+*/
+static const int kRenderPackets = 2;
+
+#ifdef SDL_PLATFORM_APPLE
+static const bool kRenderThreadSupported = false;
+#else
+static const bool kRenderThreadSupported = true;
+#endif
+
+typedef void (*RenderPacketFn)(void* user, void* packet);
+
+struct RenderThreadStats {
+    uint64_t frames = 0;
+    uint64_t mainWaits = 0; // Acquires that blocked on the render thread
+    uint64_t renderWaits = 0; // Frames the render thread sat idle waiting for a packet
+    double mainWaitMs = 0.0;
+};
+
+struct RenderThread {
+    GLContext gl{};
+    SDL_Thread* thread = nullptr; // Null when rendering on the caller's thread
+    SDL_Mutex* mutex = nullptr;
+    SDL_Condition* changed = nullptr; // A packet was submitted or finished
+
+    RenderPacketFn render = nullptr;
+    void* user = nullptr;
+    void* packets[kRenderPackets] = {};
+    bool submitted[kRenderPackets] = {}; // Owned by the render thread, not done yet
+    int writeSlot = 0; // Next packet the main thread fills
+    int readSlot = 0;  // Next packet the render thread draws
+    bool quit = false;
+    RenderThreadStats stats;
+};
+
+// Releases the GL context from the calling thread and starts the render
+// thread with it current. threaded = false renders in SubmitPacket instead.
+void StartRenderThread(RenderThread& rt, GLContext gl, RenderPacketFn render, void* user,
+                       void* packetA, void* packetB, bool threaded = true);
+// Finishes submitted packets, joins the thread and makes the GL context
+// current on the calling thread again.
+void StopRenderThread(RenderThread& rt);
+
+// The packet to fill next. Blocks while the render thread still draws it.
+void* AcquirePacket(RenderThread& rt);
+// Hands the acquired packet to the render thread.
+void SubmitPacket(RenderThread& rt);
+
+RenderThreadStats GetRenderThreadStats(RenderThread& rt);
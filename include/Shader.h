@@ -0,0 +1,98 @@
+// include/Shader.h
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/*
+* Load Shader File. Located in src/shaders.
+*/
+std::string LoadShaderSource(const char* filepath);
+// Same as LoadShaderSource but returns false instead of exiting.
+bool TryLoadShaderSource(const char* filepath, std::string& source);
+
+GLuint CompileShader(GLenum type, const char* src);
+// retrievable sets GL_PROGRAM_BINARY_RETRIEVABLE_HINT so the result can be cached.
+GLuint LinkProgram(GLuint vs, GLuint fs, bool retrievable = false);
+
+/*
+* Linked program plus everything glGetProgramiv reports about it. Reflection
+* runs once at link time; the render loop only uses the precomputed handles.
+*/
+struct ShaderUniform {
+    std::string name; // Arrays are stored without the trailing "[0]"
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 0;   // Array length, 1 for non-arrays
+    GLint block = -1; // Uniform block index, -1 for default block uniforms
+};
+
+struct ShaderAttribute {
+    std::string name;
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 0;
+};
+
+struct ShaderBlock {
+    std::string name;
+    GLuint index = GL_INVALID_INDEX;
+    GLint dataSize = 0;
+};
+
+struct ShaderProgram {
+    GLuint id = 0;
+    std::vector<ShaderUniform> uniforms;
+    std::vector<ShaderAttribute> attributes;
+    std::vector<ShaderBlock> blocks;
+};
+
+// Links vs and fs, detaches them and reflects the result.
+ShaderProgram CreateShaderProgram(GLuint vs, GLuint fs, bool retrievable = false);
+void ReflectProgram(ShaderProgram& program);
+void DestroyShaderProgram(ShaderProgram& program);
+// Deletes the GL program once the frames that may use it are done, see GLResources.h.
+void RetireShaderProgram(ShaderProgram& program);
+
+const ShaderUniform* FindUniform(const ShaderProgram& program, const char* name);
+const ShaderAttribute* FindAttribute(const ShaderProgram& program, const char* name);
+const ShaderBlock* FindBlock(const ShaderProgram& program, const char* name);
+
+/*
+* Typed uniform handle. Resolved once with GetUniform<T>, which also checks
+* that the GLSL type matches T. A handle for a missing uniform has location
+* -1 and setting it is a no-op, same as GL.
+*/
+template <typename T>
+struct UniformHandle {
+    GLint location = -1;
+    bool Valid() const { return location >= 0; }
+};
+
+// GL type enum a C++ type maps to, e.g. glm::mat4 -> GL_FLOAT_MAT4.
+template <typename T> GLenum UniformGLType();
+template <> inline GLenum UniformGLType<int>() { return GL_INT; }
+template <> inline GLenum UniformGLType<float>() { return GL_FLOAT; }
+template <> inline GLenum UniformGLType<glm::vec2>() { return GL_FLOAT_VEC2; }
+template <> inline GLenum UniformGLType<glm::vec3>() { return GL_FLOAT_VEC3; }
+template <> inline GLenum UniformGLType<glm::vec4>() { return GL_FLOAT_VEC4; }
+template <> inline GLenum UniformGLType<glm::mat4>() { return GL_FLOAT_MAT4; }
+
+// Logs a warning when the uniform exists with a different type than expected.
+GLint ResolveUniform(const ShaderProgram& program, const char* name, GLenum expectedType);
+
+template <typename T>
+UniformHandle<T> GetUniform(const ShaderProgram& program, const char* name) {
+    return UniformHandle<T>{ResolveUniform(program, name, UniformGLType<T>())};
+}
+
+// Sets a uniform on the currently bound program.
+void SetUniform(UniformHandle<int> h, int value);
+void SetUniform(UniformHandle<float> h, float value);
+void SetUniform(UniformHandle<glm::vec2> h, const glm::vec2& value);
+void SetUniform(UniformHandle<glm::vec3> h, const glm::vec3& value);
+void SetUniform(UniformHandle<glm::vec4> h, const glm::vec4& value);
+void SetUniform(UniformHandle<glm::mat4> h, const glm::mat4& value);
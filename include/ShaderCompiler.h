@@ -0,0 +1,58 @@
+// include/ShaderCompiler.h
+#pragma once
+
+#include "ProgramCache.h"
+#include "Shader.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+* Batch shader compilation. SubmitShaderJobs issues every compile and link
+* without querying any status, so drivers that compile on background threads
+* can overlap the work. With GL_KHR_parallel_shader_compile, PollShaderJobs
+* checks GL_COMPLETION_STATUS_KHR and never blocks; without it, status is
+* only read in FinishShaderJobs.
+*
+* Failures are logged and leave ok == false; they don't exit.
+*/
+struct ShaderJob {
+    std::string name;
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::string defines; // Cache key only, see ProgramCacheKey
+
+    uint64_t key = 0;
+    GLuint vs = 0;
+    GLuint fs = 0;
+    bool fromCache = false;
+    bool done = false;
+    bool ok = false;
+    ShaderProgram program;
+};
+
+struct ShaderCompileBatch {
+    ProgramCache* cache = nullptr; // Optional
+    std::vector<ShaderJob> jobs;
+    bool parallel = false; // GL_KHR_parallel_shader_compile in use
+    bool submitted = false;
+    uint32_t failed = 0;
+    double wallMs = 0.0; // Submit to last job finished
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+// Enables driver compiler threads when the extension is present.
+void InitShaderCompileBatch(ShaderCompileBatch& batch, ProgramCache* cache);
+
+// Returns the job index. The job's program is valid once it is done and ok.
+size_t AddShaderJob(ShaderCompileBatch& batch, const std::string& name, const std::string& vertexSource,
+                    const std::string& fragmentSource, const std::string& defines = "");
+void SubmitShaderJobs(ShaderCompileBatch& batch);
+// Finishes the jobs the driver has completed. Returns true when all are done.
+bool PollShaderJobs(ShaderCompileBatch& batch);
+// Blocks until every job is done.
+void FinishShaderJobs(ShaderCompileBatch& batch);
+
+void PrintShaderCompileStats(const ShaderCompileBatch& batch);
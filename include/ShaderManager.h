@@ -0,0 +1,74 @@
+// include/ShaderManager.h
+#pragma once
+
+#include "ProgramCache.h"
+#include "Shader.h"
+#include "ShaderCompiler.h"
+#include "ShaderPreprocessor.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+* Owns the app's shader programs and reloads them when their files change.
+*
+* The shader directory is watched with inotify on Linux and by polling file
+* times elsewhere. Changed programs are rebuilt through a ShaderCompileBatch
+* that is polled once per frame, so with parallel compile support the frame
+* loop never waits on the compiler. A program is swapped in only when it
+* compiles and links; otherwise the old one stays and the error is logged.
+*
+* Sources go through the ShaderPreprocessor, and every file a program
+* includes counts as one of its dependencies. Each (files, defines) pair is
+* one permutation and is only built once, however often it is requested.
+*
+* Entries live in a deque, so references from GetShaderProgram stay valid.
+* The id and uniform locations inside change on reload: check version or
+* compare ids and re-resolve handles when it moves.
+*/
+struct ShaderEntry {
+    std::string name;
+    std::string vertexFile; // Relative to the manager directory
+    std::string fragmentFile;
+    ShaderDefines defines;
+    std::string glslVersion; // Overrides the manager's #version line when set
+    std::vector<std::string> files; // Every file either stage pulled in
+    ShaderProgram program;
+    uint32_t version = 0; // Bumped on every successful swap
+    bool dirty = false;
+};
+
+struct ShaderManager {
+    std::string directory;
+    std::string version = "#version 330 core"; // Injected into every shader
+    ProgramCache* cache = nullptr;
+    std::deque<ShaderEntry> entries;
+    std::unordered_map<std::string, size_t> permutations; // Files + defines key -> entry
+
+    ShaderCompileBatch reload;
+    std::vector<size_t> reloadEntries; // Entry index per reload job
+    bool reloading = false;
+
+    int watchFd = -1;           // inotify instance, Linux only
+    std::unordered_map<int, std::string> watchDirs; // inotify watch -> directory relative to ours
+    uint64_t lastPollTicks = 0; // Polling fallback
+    std::unordered_map<std::string, int64_t> fileTimes; // Polling fallback
+};
+
+void InitShaderManager(ShaderManager& sm, const char* directory, ProgramCache* cache);
+void CleanupShaderManager(ShaderManager& sm);
+
+// Returns the existing entry when this permutation was added before.
+// glslVersion is a full line such as "#version 430 core"; empty uses sm.version.
+size_t AddShaderProgram(ShaderManager& sm, const std::string& name, const std::string& vertexFile,
+                        const std::string& fragmentFile, const ShaderDefines& defines = {},
+                        const std::string& glslVersion = "");
+// Builds every added program; returns false if any fails.
+bool LoadShaderPrograms(ShaderManager& sm);
+// Call once per frame: picks up file changes and swaps in finished rebuilds.
+void UpdateShaderManager(ShaderManager& sm);
+
+const ShaderProgram& GetShaderProgram(const ShaderManager& sm, size_t index);
@@ -0,0 +1,36 @@
+// include/ShaderPreprocessor.h
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+* GLSL preprocessing done before the driver sees the source:
+*  - #include "file" is resolved relative to the including file. Each file
+*    is pulled in once per shader, like #pragma once, and cycles are errors.
+*  - The #version line of the root file is replaced by the given one.
+*  - The define set is injected right after #version.
+*
+* #line directives keep driver errors pointing at the right place. GLSL only
+* allows a number for the source, so errors read "<file index>:<line>" where
+* the index is into PreprocessedShader::files.
+*/
+struct ShaderDefine {
+    std::string name;
+    std::string value; // Empty for a plain #define NAME
+};
+
+using ShaderDefines = std::vector<ShaderDefine>;
+
+struct PreprocessedShader {
+    std::string source;
+    std::vector<std::string> files; // Root first, paths relative to the directory
+    std::string error;
+};
+
+// Order independent, so {A, B} and {B, A} give the same key.
+std::string ShaderDefinesKey(const ShaderDefines& defines);
+
+// version is a full line such as "#version 330 core"; empty keeps the file's own.
+bool PreprocessShader(const std::string& directory, const std::string& file, const ShaderDefines& defines,
+                      const std::string& version, PreprocessedShader& out);
@@ -0,0 +1,44 @@
+// include/SimClock.h
+#pragma once
+
+#include <cstdint>
+
+/*
+* Fixed timestep scheduler. Real time is added to an accumulator and spent
+* in whole steps of stepNs, so the simulation advances by the same dt
+* however fast frames are rendered. What's left over, as a fraction of a
+* step, is alpha: render state is interpolated between the last two
+* simulated states by it, so motion stays smooth when the simulation runs
+* slower than the display.
+*
+* Everything is integer nanoseconds. Sim time is the sum of the steps
+* handed out, each at the step length it ran with, so changing the tick
+* rate doesn't rescale the past. It never loses precision, unlike a float
+* of seconds since startup.
+*
+* After a long stall (breakpoint, window drag) at most maxSteps run in one
+* frame and the rest of the backlog is dropped, so one slow frame can't
+* snowball into ever more steps per frame.
+*/
+struct SimClock {
+    uint64_t stepNs = 0;
+    uint64_t lastNs = 0; // Time passed to the previous AdvanceSimClock
+    uint64_t accumulatorNs = 0; // Real time not simulated yet, under a step after AdvanceSimClock
+    uint64_t tick = 0; // Steps handed out so far
+    uint64_t simNs = 0; // Their total length
+    int maxSteps = 8; // Per frame
+    uint64_t droppedNs = 0; // Backlog thrown away because of maxSteps
+    double alpha = 0.0; // accumulatorNs / stepNs, for interpolation
+};
+
+void InitSimClock(SimClock& c, double tickRate, uint64_t nowNs);
+// Takes effect from the next step, the accumulator is kept.
+void SetSimTickRate(SimClock& c, double tickRate);
+
+// Accumulates the time since the last call and returns how many steps to
+// run now. nowNs is any monotonic nanosecond clock, e.g. SDL_GetTicksNS().
+int AdvanceSimClock(SimClock& c, uint64_t nowNs);
+
+double SimStepSeconds(const SimClock& c);
+double SimSeconds(const SimClock& c); // At the end of the steps handed out
+double SimTickRate(const SimClock& c);
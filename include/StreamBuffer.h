@@ -0,0 +1,65 @@
+// include/StreamBuffer.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLResources.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Streaming ring buffer for per-frame dynamic data (vertices, indices, uniforms).
+*
+* On GL 4.4+ the buffer is allocated once with glBufferStorage and stays
+* persistently and coherently mapped. The ring is split into segments and each
+* segment gets a glFenceSync when the ring moves past it, so the CPU only waits
+* when it is about to overwrite data the GPU may still be reading.
+*
+* On older contexts the buffer is orphaned with glBufferData whenever the ring
+* wraps and each allocation is mapped unsynchronized until StreamCommit.
+*/
+static const int kStreamMaxSegments = 8;
+
+struct StreamStats {
+    uint64_t bytesAllocated = 0;
+    uint32_t fenceWaits = 0; // Waits where the GPU had not finished yet
+    uint32_t orphans = 0;
+};
+
+struct StreamAllocation {
+    void* ptr = nullptr;
+    size_t offset = 0; // Byte offset into the GL buffer
+    size_t size = 0;
+};
+
+struct StreamBuffer {
+    BufferHandle buffer;
+    size_t size = 0;
+    bool persistent = false;
+    uint8_t* mapped = nullptr;
+
+    size_t head = 0;
+    int segmentCount = 0;
+    size_t segmentSize = 0;
+    int segment = 0; // Segment head is currently in
+    GLsync fences[kStreamMaxSegments] = {};
+
+    StreamStats stats;
+};
+
+// Total size is segmentSize * segments; a single allocation can't exceed segmentSize.
+void InitStreamBuffer(StreamBuffer& sb, size_t segmentSize, int segments = 3);
+void CleanupStreamBuffer(StreamBuffer& sb);
+
+// Returns a write pointer for size bytes starting at a multiple of alignment
+// (alignment need not be a power of two). ptr is null if size > segmentSize.
+StreamAllocation StreamAlloc(StreamBuffer& sb, size_t size, size_t alignment = 4);
+// True if StreamAlloc can place the allocation in the current segment, so
+// it won't fence the segment and move on to the next one.
+bool StreamFits(const StreamBuffer& sb, size_t size, size_t alignment = 4);
+// Must be called after writing an allocation and before the GPU uses it.
+void StreamCommit(StreamBuffer& sb, const StreamAllocation& alloc);
+// Fences the current segment and moves on to the next. Call once per frame
+// after the draws reading this frame's data have been issued.
+void StreamEndFrame(StreamBuffer& sb);
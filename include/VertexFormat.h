@@ -0,0 +1,99 @@
+// include/VertexFormat.h
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLResources.h"
+#include "Hash.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Declarative vertex layouts. A VertexFormat lists the vertex buffer
+* bindings (stride, divisor) and the attributes read from each (location,
+* type, component count, offset). BindVertexFormat binds the VAO cached for
+* a format and index buffer, looked up by the format's hash (and checked
+* against the stored layout) and created on first use; BindVertexBuffer
+* then points one of its bindings at a buffer.
+*
+* On GL 4.3 the VAO's layout is set once with glVertexAttribFormat and
+* glVertexAttribBinding, and pointing a binding somewhere else is a single
+* glBindVertexBuffer. On 3.3 the VAO only has the attributes enabled and
+* BindVertexBuffer re-specifies the binding's attributes with
+* glVertexAttribPointer. Either way each VAO remembers what its bindings
+* point at, and binding the same buffer and offset again is skipped.
+*
+* Compact types cut vertex bandwidth: half floats, normalized 8 and 16 bit
+* integers and packed 10-10-10-2. Normalized types read as floats in [0, 1]
+* or [-1, 1], so shaders don't change; write them with glm's packing
+* functions (glm/gtc/packing.hpp: packHalf1x16, packUnorm4x8,
+* packSnorm3x10_1x2, ...).
+*
+* Buffers are identified by handle, so a VAO never mistakes a new buffer
+* for a deleted one that had the same name. Like GLState, the cache belongs
+* to the one GL context.
+*/
+static const int kVertexMaxAttribs = 8;
+static const int kVertexMaxBindings = 4;
+
+enum class VertexAttribType : uint8_t {
+    Float,
+    Half,
+    UNorm8,
+    SNorm8,
+    UNorm16,
+    SNorm16,
+    UNorm10_10_10_2, // Always 4 components in one uint32, x in the low bits
+    SNorm10_10_10_2,
+    UInt, // Integer attribute, read as uint/uvec in the shader
+};
+
+struct VertexAttrib {
+    uint8_t location = 0;
+    VertexAttribType type = VertexAttribType::Float;
+    uint8_t components = 0;
+    uint8_t binding = 0;
+    uint16_t offset = 0; // Within the binding's vertex
+};
+
+struct VertexBinding {
+    uint16_t stride = 0;
+    uint16_t divisor = 0; // 0 per vertex, 1 per instance
+};
+
+struct VertexFormat {
+    VertexAttrib attribs[kVertexMaxAttribs];
+    VertexBinding bindings[kVertexMaxBindings];
+    uint8_t attribCount = 0;
+    uint8_t bindingCount = 0;
+    uint64_t hash = kHashSeed; // Of everything added so far
+};
+
+struct VertexFormatStats {
+    uint32_t vertexArrays = 0; // Cached
+    uint32_t bufferBinds = 0;
+    uint32_t bufferBindsElided = 0;
+};
+
+// Returns the new binding's index.
+uint32_t AddVertexBinding(VertexFormat& format, uint16_t stride, uint16_t divisor = 0);
+// Packed 10-10-10-2 types need 4 components.
+void AddVertexAttrib(VertexFormat& format, uint8_t location, VertexAttribType type, uint8_t components,
+                     uint16_t offset, uint8_t binding = 0);
+size_t VertexAttribSize(VertexAttribType type, uint8_t components);
+
+// Binds (through GLState) the VAO for format with indexBuffer as its
+// element buffer, creating it on first use, and returns its GL name.
+GLuint BindVertexFormat(const VertexFormat& format, BufferHandle indexBuffer = BufferHandle{});
+// Points binding of the VAO of the last BindVertexFormat at buffer + offset.
+void BindVertexBuffer(uint32_t binding, BufferHandle buffer, size_t offset = 0);
+// Destroys the VAOs using indexBuffer, for when the buffer goes away.
+void ReleaseVertexArrays(BufferHandle indexBuffer);
+void CleanupVertexFormats();
+// Uses the 3.3 glVertexAttribPointer path on a 4.3 context too, so it can be
+// checked there. Call before the first BindVertexFormat.
+void ForceVertexAttribPointers(bool force);
+
+VertexFormatStats GetVertexFormatStats();
+void PrintVertexFormatStats();
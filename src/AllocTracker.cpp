@@ -0,0 +1,231 @@
+// src/AllocTracker.cpp
+
+#include "AllocTracker.h"
+
+#include <SDL3/SDL.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Plain atomics, no constructors that could run after the first allocation
+struct AllocZoneCounts {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint32_t> frameAllocations{0};
+};
+
+static AllocZoneCounts sZones[kAllocMaxZones];
+static std::atomic<int> sZoneCount{0};
+static SDL_SpinLock sZoneLock = 0;
+
+static std::atomic<uint32_t> sFrameAllocations{0};
+static std::atomic<uint32_t> sFrameFrees{0};
+static std::atomic<uint64_t> sFrameBytes{0};
+static std::atomic<uint64_t> sAllocations{0};
+static std::atomic<uint64_t> sFrees{0};
+static std::atomic<uint64_t> sBytes{0};
+
+// Only touched by the thread calling EndAllocFrame
+static uint64_t sFrame = 0;
+static uint64_t sFlaggedFrames = 0;
+static bool sCheck = false;
+static int sWarmupFrames = 0;
+
+static thread_local int tZone = -1;
+
+static void CountAlloc(void* ptr, size_t size) {
+    (void)ptr; // When Tracy is compiled out
+    sFrameAllocations.fetch_add(1, std::memory_order_relaxed);
+    sFrameBytes.fetch_add(size, std::memory_order_relaxed);
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    sBytes.fetch_add(size, std::memory_order_relaxed);
+    int zone = tZone;
+    if (zone >= 0) {
+        sZones[zone].allocations.fetch_add(1, std::memory_order_relaxed);
+        sZones[zone].bytes.fetch_add(size, std::memory_order_relaxed);
+        sZones[zone].frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    TracyAlloc(ptr, size);
+}
+
+static void CountFree(void* ptr) {
+    (void)ptr;
+    sFrameFrees.fetch_add(1, std::memory_order_relaxed);
+    sFrees.fetch_add(1, std::memory_order_relaxed);
+    TracyFree(ptr);
+}
+
+static void* AllocOrThrow(size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    CountAlloc(ptr, size);
+    return ptr;
+}
+
+static void* AllocAligned(size_t size, size_t align) {
+    if (size == 0) size = 1;
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size, align);
+#else
+    void* ptr = std::aligned_alloc(align, (size + align - 1) & ~(align - 1)); // Size must be a multiple
+#endif
+    if (ptr) CountAlloc(ptr, size);
+    return ptr;
+}
+
+static void FreeTracked(void* ptr) {
+    if (!ptr) return;
+    CountFree(ptr);
+    std::free(ptr);
+}
+
+static void FreeAligned(void* ptr) {
+    if (!ptr) return;
+    CountFree(ptr);
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) { return AllocOrThrow(size); }
+void* operator new[](size_t size) { return AllocOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr) CountAlloc(ptr, size);
+    return ptr;
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void* operator new(size_t size, std::align_val_t align) {
+    void* ptr = AllocAligned(size, (size_t)align);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+void* operator new[](size_t size, std::align_val_t align) { return operator new(size, align); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocAligned(size, (size_t)align);
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return AllocAligned(size, (size_t)align);
+}
+
+void operator delete(void* ptr) noexcept { FreeTracked(ptr); }
+void operator delete[](void* ptr) noexcept { FreeTracked(ptr); }
+void operator delete(void* ptr, size_t) noexcept { FreeTracked(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { FreeTracked(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { FreeTracked(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { FreeTracked(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { FreeAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(ptr); }
+
+void* TrackedAlloc(size_t size, void* user) {
+    (void)user;
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr) CountAlloc(ptr, size);
+    return ptr;
+}
+
+void TrackedFree(void* ptr, void* user) {
+    (void)user;
+    FreeTracked(ptr);
+}
+
+static int FindZone(const char* name) {
+    int count = sZoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (sZones[i].name.load(std::memory_order_relaxed) == name) return i;
+    }
+    return -1;
+}
+
+int PushAllocZone(const char* name) {
+    int previous = tZone;
+    int zone = FindZone(name);
+    if (zone < 0) {
+        // First time this zone is seen, look again under the lock in case
+        // another thread just added it
+        SDL_LockSpinlock(&sZoneLock);
+        zone = FindZone(name);
+        int count = sZoneCount.load(std::memory_order_relaxed);
+        if (zone < 0 && count < kAllocMaxZones) {
+            sZones[count].name.store(name, std::memory_order_relaxed);
+            sZoneCount.store(count + 1, std::memory_order_release);
+            zone = count;
+        }
+        SDL_UnlockSpinlock(&sZoneLock);
+    }
+    tZone = zone; // -1 once the table is full: counted for the frame only
+    return previous;
+}
+
+void PopAllocZone(int previous) {
+    tZone = previous;
+}
+
+void SetAllocCheck(bool enabled, int warmupFrames) {
+    sCheck = enabled;
+    sWarmupFrames = warmupFrames;
+}
+
+AllocFrameStats EndAllocFrame() {
+    AllocFrameStats stats;
+    stats.frame = sFrame++;
+    stats.allocations = sFrameAllocations.exchange(0, std::memory_order_relaxed);
+    stats.frees = sFrameFrees.exchange(0, std::memory_order_relaxed);
+    stats.bytes = sFrameBytes.exchange(0, std::memory_order_relaxed);
+    TracyPlot("Frame allocations", (int64_t)stats.allocations);
+
+    // Zone counts are gathered even when not reported, so each report only
+    // covers its own frame
+    uint32_t zoneAllocations[kAllocMaxZones];
+    int zones = sZoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < zones; i++) {
+        zoneAllocations[i] = sZones[i].frameAllocations.exchange(0, std::memory_order_relaxed);
+    }
+    if (stats.frame < (uint64_t)sWarmupFrames || stats.allocations == 0) return stats;
+    sFlaggedFrames++;
+    if (!sCheck) return stats;
+
+    std::cerr << "Frame " << stats.frame << ": " << stats.allocations << " allocations (" << stats.bytes
+              << " bytes), " << stats.frees << " frees;";
+    uint32_t zoned = 0;
+    for (int i = 0; i < zones; i++) {
+        if (!zoneAllocations[i]) continue;
+        std::cerr << " " << sZones[i].name.load(std::memory_order_relaxed) << " " << zoneAllocations[i];
+        zoned += zoneAllocations[i];
+    }
+    if (zoned < stats.allocations) std::cerr << " outside zones " << stats.allocations - zoned;
+    std::cerr << "\n";
+    return stats;
+}
+
+AllocTotals GetAllocTotals() {
+    AllocTotals totals;
+    totals.allocations = sAllocations.load(std::memory_order_relaxed);
+    totals.frees = sFrees.load(std::memory_order_relaxed);
+    totals.bytes = sBytes.load(std::memory_order_relaxed);
+    totals.flaggedFrames = sFlaggedFrames;
+    return totals;
+}
+
+void PrintAllocStats() {
+    AllocTotals totals = GetAllocTotals();
+    std::cout << "Allocations: " << totals.allocations << " (" << totals.bytes / 1024.0 << " KB), "
+              << totals.frees << " frees; " << totals.flaggedFrames << " of " << sFrame
+              << " frames allocated after the warm up of " << sWarmupFrames << "\n";
+    int zones = sZoneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < zones; i++) {
+        uint64_t allocations = sZones[i].allocations.load(std::memory_order_relaxed);
+        if (!allocations) continue;
+        std::cout << "  " << sZones[i].name.load(std::memory_order_relaxed) << ": " << allocations << " ("
+                  << sZones[i].bytes.load(std::memory_order_relaxed) / 1024.0 << " KB)\n";
+    }
+}
@@ -0,0 +1,200 @@
+// src/BatchRenderer.cpp
+
+#include "BatchRenderer.h"
+#include "GLState.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <tracy/Tracy.hpp>
+
+// Makes room for a shape, flushing the batch when it would overflow.
+// Returns the index of the first vertex the shape will write.
+static uint32_t BatchReserve(BatchRenderer& r, size_t vertexCount, size_t indexCount) {
+    if (r.vertices.size() + vertexCount > r.maxVertices ||
+        r.indices.size() + indexCount > r.maxIndices) {
+        BatchFlush(r);
+    }
+    r.stats.shapes++;
+    return (uint32_t)r.vertices.size();
+}
+
+void InitBatchRenderer(BatchRenderer& r, const ShaderProgram& program, size_t maxVertices) {
+    r.shader = &program;
+    r.program = program.id;
+    r.uViewProj = GetUniform<glm::mat4>(program, "uViewProj");
+
+    r.maxVertices = maxVertices;
+    r.maxIndices = maxVertices * 3 / 2; // Enough for quads, fans use less
+    r.vertices.reserve(r.maxVertices);
+    r.indices.reserve(r.maxIndices);
+
+    // One full batch per segment, so a flush always fits
+    InitStreamBuffer(r.vertexStream, r.maxVertices * sizeof(BatchVertex));
+    InitStreamBuffer(r.indexStream, r.maxIndices * sizeof(uint32_t));
+
+    // The VAO is cached per format and index buffer, so this one is the batch's alone
+    r.vao = BindVertexFormat(BatchVertexFormat(), r.indexStream.buffer);
+    BindVertexBuffer(0, r.vertexStream.buffer);
+    StateBindVertexArray(0);
+}
+
+VertexFormat BatchVertexFormat() {
+    VertexFormat format;
+    AddVertexBinding(format, sizeof(BatchVertex));
+    AddVertexAttrib(format, 0, VertexAttribType::Float, 2, offsetof(BatchVertex, pos));
+    AddVertexAttrib(format, 1, VertexAttribType::UNorm8, 4, offsetof(BatchVertex, color));
+    return format;
+}
+
+void CleanupBatchRenderer(BatchRenderer& r) {
+    ReleaseVertexArrays(r.indexStream.buffer);
+    r.vao = 0;
+    CleanupStreamBuffer(r.vertexStream);
+    CleanupStreamBuffer(r.indexStream);
+    r.vertices.clear();
+    r.indices.clear();
+}
+
+void BatchBegin(BatchRenderer& r, const glm::mat4& viewProj) {
+    r.viewProj = viewProj;
+    r.stats = BatchStats{};
+    r.vertices.clear();
+    r.indices.clear();
+
+    if (r.shader->id != r.program) {
+        // Program was swapped by a reload, locations may have moved
+        r.program = r.shader->id;
+        r.uViewProj = GetUniform<glm::mat4>(*r.shader, "uViewProj");
+    }
+    StateUseProgram(r.program);
+    SetUniform(r.uViewProj, r.viewProj);
+}
+
+void BatchFlush(BatchRenderer& r) {
+    if (r.indices.empty()) return;
+    ZoneScoped;
+
+    size_t vertexBytes = r.vertices.size() * sizeof(BatchVertex);
+    size_t indexBytes = r.indices.size() * sizeof(uint32_t);
+    if (r.queue && (!StreamFits(r.vertexStream, vertexBytes, sizeof(BatchVertex)) ||
+                    !StreamFits(r.indexStream, indexBytes, sizeof(uint32_t)))) {
+        // Moving on fences the segment and may wrap back onto the frame's
+        // first one, so the queued draws reading them go out first
+        ExecuteDrawQueue(*r.queue);
+        r.stats.queueSplits++;
+    }
+    // Vertex data must start on a whole vertex so it can be addressed with baseVertex
+    StreamAllocation va = StreamAlloc(r.vertexStream, vertexBytes, sizeof(BatchVertex));
+    StreamAllocation ia = StreamAlloc(r.indexStream, indexBytes, sizeof(uint32_t));
+    if (!va.ptr || !ia.ptr) {
+        std::cerr << "BatchFlush: stream allocation failed, dropping batch\n";
+        StreamCommit(r.vertexStream, va);
+        StreamCommit(r.indexStream, ia);
+        r.vertices.clear();
+        r.indices.clear();
+        return;
+    }
+    std::memcpy(va.ptr, r.vertices.data(), vertexBytes);
+    std::memcpy(ia.ptr, r.indices.data(), indexBytes);
+    StreamCommit(r.vertexStream, va);
+    StreamCommit(r.indexStream, ia);
+
+    if (r.queue) {
+        DrawCommand cmd;
+        cmd.program = r.program;
+        cmd.vao = r.vao;
+        cmd.count = (GLsizei)r.indices.size();
+        cmd.indexType = GL_UNSIGNED_INT;
+        cmd.first = ia.offset;
+        cmd.baseVertex = (GLint)(va.offset / sizeof(BatchVertex));
+        SubmitDraw(*r.queue, MakeDrawKey(r.layer, r.program, 0, 0), cmd);
+    } else {
+        StateUseProgram(r.program);
+        StateBindVertexArray(r.vao);
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)r.indices.size(), GL_UNSIGNED_INT,
+                                 (void*)ia.offset, (GLint)(va.offset / sizeof(BatchVertex)));
+    }
+
+    r.stats.drawCalls++;
+    r.stats.vertices += (uint32_t)r.vertices.size();
+    r.stats.indices += (uint32_t)r.indices.size();
+    r.vertices.clear();
+    r.indices.clear();
+}
+
+void BatchEnd(BatchRenderer& r) {
+    BatchFlush(r);
+    if (!r.queue) BatchFenceFrame(r);
+}
+
+void BatchFenceFrame(BatchRenderer& r) {
+    StreamEndFrame(r.vertexStream);
+    StreamEndFrame(r.indexStream);
+}
+
+void BatchPushTriangle(BatchRenderer& r, glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec4 color) {
+    uint32_t base = BatchReserve(r, 3, 3);
+    uint32_t packed = glm::packUnorm4x8(color);
+    r.vertices.push_back({a, packed});
+    r.vertices.push_back({b, packed});
+    r.vertices.push_back({c, packed});
+    r.indices.insert(r.indices.end(), {base, base + 1, base + 2});
+}
+
+void BatchPushQuad(BatchRenderer& r, glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, glm::vec4 color) {
+    uint32_t base = BatchReserve(r, 4, 6);
+    uint32_t packed = glm::packUnorm4x8(color);
+    r.vertices.push_back({a, packed});
+    r.vertices.push_back({b, packed});
+    r.vertices.push_back({c, packed});
+    r.vertices.push_back({d, packed});
+    r.indices.insert(r.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+}
+
+void BatchPushRect(BatchRenderer& r, glm::vec2 center, glm::vec2 size, float angle, glm::vec4 color) {
+    glm::vec2 h = size * 0.5f;
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    // Rotated half extents along the local x and y axes
+    glm::vec2 x = glm::vec2(c, s) * h.x;
+    glm::vec2 y = glm::vec2(-s, c) * h.y;
+    BatchPushQuad(r, center - x - y, center + x - y, center + x + y, center - x + y, color);
+}
+
+void BatchPushCircle(BatchRenderer& r, glm::vec2 center, float radius, glm::vec4 color, int segments) {
+    if (segments < 3) segments = 3;
+    if ((size_t)segments + 1 > r.maxVertices || (size_t)segments * 3 > r.maxIndices) {
+        std::cerr << "BatchPushCircle: circle with " << segments << " segments exceeds batch size\n";
+        return;
+    }
+    uint32_t base = BatchReserve(r, segments + 1, segments * 3);
+    uint32_t packed = glm::packUnorm4x8(color);
+    r.vertices.push_back({center, packed});
+    const float step = 6.28318530718f / segments;
+    for (int i = 0; i < segments; i++) {
+        glm::vec2 p = center + radius * glm::vec2(std::cos(i * step), std::sin(i * step));
+        r.vertices.push_back({p, packed});
+        uint32_t next = (i + 1) % segments;
+        r.indices.insert(r.indices.end(), {base, base + 1 + i, base + 1 + next});
+    }
+}
+
+void BatchPushPolygon(BatchRenderer& r, const glm::vec2* points, size_t count, glm::vec4 color) {
+    if (count < 3) return;
+    if (count > r.maxVertices || (count - 2) * 3 > r.maxIndices) {
+        std::cerr << "BatchPushPolygon: polygon with " << count << " points exceeds batch size\n";
+        return;
+    }
+    uint32_t base = BatchReserve(r, count, (count - 2) * 3);
+    uint32_t packed = glm::packUnorm4x8(color);
+    for (size_t i = 0; i < count; i++) {
+        r.vertices.push_back({points[i], packed});
+    }
+    for (uint32_t i = 1; i + 1 < count; i++) {
+        r.indices.insert(r.indices.end(), {base, base + i, base + i + 1});
+    }
+}
@@ -0,0 +1,129 @@
+// src/DrawQueue.cpp
+
+#include "DrawQueue.h"
+#include "GLState.h"
+
+#include <chrono>
+#include <cstring>
+
+#include <tracy/Tracy.hpp>
+
+static const int kRadixBits = 8;
+static const int kRadixPasses = 64 / kRadixBits;
+static const int kRadixBuckets = 1 << kRadixBits;
+
+void ReserveDrawQueue(DrawQueue& q, size_t count) {
+    q.commands.reserve(count);
+    q.keys.reserve(count);
+    q.order.reserve(count);
+    q.scratchKeys.reserve(count);
+    q.scratchOrder.reserve(count);
+}
+
+void SubmitDraw(DrawQueue& q, uint64_t key, const DrawCommand& cmd) {
+    q.keys.push_back(key);
+    q.commands.push_back(cmd);
+}
+
+void SortDrawQueue(DrawQueue& q) {
+    ZoneScoped;
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t n = q.keys.size();
+    q.order.resize(n);
+    for (size_t i = 0; i < n; i++) q.order[i] = (uint32_t)i;
+    q.scratchKeys.resize(n);
+    q.scratchOrder.resize(n);
+
+    // All histograms in one read of the keys
+    uint32_t counts[kRadixPasses][kRadixBuckets];
+    std::memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k = q.keys[i];
+        for (int p = 0; p < kRadixPasses; p++) {
+            counts[p][(k >> (p * kRadixBits)) & (kRadixBuckets - 1)]++;
+        }
+    }
+
+    // LSD passes, stable, so equal keys keep submission order. A byte that is
+    // the same for every key (unused layers, depth 0, ...) skips its pass.
+    uint64_t* keys = q.keys.data();
+    uint32_t* order = q.order.data();
+    uint64_t* keysOut = q.scratchKeys.data();
+    uint32_t* orderOut = q.scratchOrder.data();
+    for (int p = 0; p < kRadixPasses; p++) {
+        int shift = p * kRadixBits;
+        uint32_t* c = counts[p];
+        if (n == 0 || c[(keys[0] >> shift) & (kRadixBuckets - 1)] == n) continue;
+
+        uint32_t offsets[kRadixBuckets];
+        uint32_t sum = 0;
+        for (int b = 0; b < kRadixBuckets; b++) {
+            offsets[b] = sum;
+            sum += c[b];
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint32_t dst = offsets[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+            keysOut[dst] = keys[i];
+            orderOut[dst] = order[i];
+        }
+        std::swap(keys, keysOut);
+        std::swap(order, orderOut);
+    }
+
+    // An odd number of passes leaves the result in the scratch arrays
+    if (keys != q.keys.data()) {
+        q.keys.swap(q.scratchKeys);
+        q.order.swap(q.scratchOrder);
+    }
+
+    q.stats.sortMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ExecuteDrawQueue(DrawQueue& q) {
+    ZoneScoped;
+    SortDrawQueue(q);
+    q.stats.submitted = (uint32_t)q.commands.size();
+    q.stats.programSwitches = 0;
+    q.stats.textureSwitches = 0;
+
+    GLuint program = 0xFFFFFFFFu;
+    GLuint texture = 0;
+    for (uint32_t index : q.order) {
+        const DrawCommand& cmd = q.commands[index];
+        if (cmd.program != program) {
+            program = cmd.program;
+            q.stats.programSwitches++;
+        }
+        StateUseProgram(cmd.program);
+        StateBindVertexArray(cmd.vao);
+        if (cmd.texture && cmd.texture != texture) {
+            texture = cmd.texture;
+            q.stats.textureSwitches++;
+            StateBindTexture(0, GL_TEXTURE_2D, cmd.texture);
+        }
+
+        if (cmd.indexType) {
+            if (cmd.instances > 1) {
+                glDrawElementsInstancedBaseVertex(cmd.mode, cmd.count, cmd.indexType, (void*)cmd.first,
+                                                  cmd.instances, cmd.baseVertex);
+            } else {
+                glDrawElementsBaseVertex(cmd.mode, cmd.count, cmd.indexType, (void*)cmd.first,
+                                         cmd.baseVertex);
+            }
+        } else {
+            if (cmd.instances > 1) {
+                glDrawArraysInstanced(cmd.mode, (GLint)cmd.first, cmd.count, cmd.instances);
+            } else {
+                glDrawArrays(cmd.mode, (GLint)cmd.first, cmd.count);
+            }
+        }
+    }
+    ClearDrawQueue(q);
+}
+
+void ClearDrawQueue(DrawQueue& q) {
+    q.commands.clear();
+    q.keys.clear();
+    q.order.clear();
+}
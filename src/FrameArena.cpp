@@ -0,0 +1,124 @@
+// src/FrameArena.cpp
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <tracy/Tracy.hpp>
+
+static const size_t kArenaGrowGranularity = 64 * 1024;
+
+struct ArenaOverflow {
+    ArenaOverflow* next;
+    size_t size; // Bytes after the header, alignment slack included
+};
+
+static size_t AlignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static uint8_t* AllocBlock(size_t size) {
+    uint8_t* block = (uint8_t*)std::malloc(size);
+    if (!block) {
+        std::cerr << "FrameArena: out of memory allocating " << size << " bytes\n";
+        std::exit(-1);
+    }
+    return block;
+}
+
+void InitArena(LinearArena& arena, const char* name, size_t capacity) {
+    arena.name = name;
+    arena.capacity = AlignUp(std::max<size_t>(capacity, 1), kArenaGrowGranularity);
+    arena.base = AllocBlock(arena.capacity);
+    arena.offset = 0;
+    arena.lastOffset = 0;
+    arena.overflow = nullptr;
+    arena.overflowBytes = 0;
+    arena.stats = ArenaStats{};
+}
+
+static void FreeOverflow(LinearArena& arena) {
+    while (arena.overflow) {
+        ArenaOverflow* next = arena.overflow->next;
+        std::free(arena.overflow);
+        arena.overflow = next;
+    }
+}
+
+void CleanupArena(LinearArena& arena) {
+    FreeOverflow(arena);
+    arena.overflowBytes = 0;
+    std::free(arena.base);
+    arena.base = nullptr;
+    arena.capacity = 0;
+    arena.offset = 0;
+}
+
+void* ArenaAlloc(LinearArena& arena, size_t size, size_t align) {
+    arena.stats.allocations++;
+    size_t start = AlignUp(arena.offset, align);
+    if (start + size <= arena.capacity) {
+        arena.lastOffset = start;
+        arena.offset = start + size;
+        arena.stats.used = arena.offset + arena.overflowBytes;
+        return arena.base + start;
+    }
+
+    // Doesn't fit: a heap block for this one, freed at reset
+    ArenaOverflow* block = (ArenaOverflow*)AllocBlock(sizeof(ArenaOverflow) + size + align);
+    block->next = arena.overflow;
+    block->size = size + align;
+    arena.overflow = block;
+    arena.overflowBytes += size;
+    arena.stats.overflows++;
+    arena.stats.used = arena.offset + arena.overflowBytes;
+    uintptr_t data = (uintptr_t)(block + 1);
+    return (void*)AlignUp(data, align);
+}
+
+void ArenaFree(LinearArena& arena, void* ptr, size_t size) {
+    // Only the latest allocation in the block can be given back
+    if ((uint8_t*)ptr != arena.base + arena.lastOffset || arena.lastOffset + size != arena.offset) return;
+    if (arena.poison) std::memset(arena.base + arena.lastOffset, kArenaPoisonByte, size);
+    arena.offset = arena.lastOffset;
+    arena.stats.used = arena.offset + arena.overflowBytes;
+}
+
+void ResetArena(LinearArena& arena) {
+    ZoneScopedN("Reset Arena");
+    ArenaStats& stats = arena.stats;
+    stats.highWater = std::max(stats.highWater, stats.used);
+    if (arena.poison) {
+        std::memset(arena.base, kArenaPoisonByte, arena.offset);
+        for (ArenaOverflow* block = arena.overflow; block; block = block->next) {
+            std::memset(block + 1, kArenaPoisonByte, block->size);
+        }
+    }
+
+    // Last frame didn't fit: grow so this one does, with some headroom
+    if (arena.overflow) {
+        FreeOverflow(arena);
+        arena.overflowBytes = 0;
+        size_t capacity = AlignUp(stats.highWater + stats.highWater / 4, kArenaGrowGranularity);
+        std::free(arena.base);
+        arena.base = AllocBlock(capacity);
+        if (arena.poison) std::memset(arena.base, kArenaPoisonByte, capacity);
+        arena.capacity = capacity;
+        stats.grows++;
+    }
+
+    arena.offset = 0;
+    arena.lastOffset = 0;
+    stats.used = 0;
+    stats.allocations = 0;
+    stats.overflows = 0;
+}
+
+void PrintArenaStats(const LinearArena& arena) {
+    const ArenaStats& stats = arena.stats;
+    std::cout << arena.name << ": high water " << std::max(stats.highWater, stats.used) / 1024.0
+              << " KB of " << arena.capacity / 1024.0 << " KB, grew " << stats.grows << " times\n";
+}
@@ -0,0 +1,153 @@
+// src/FramePacer.cpp
+
+#include "FramePacer.h"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <tracy/Tracy.hpp>
+
+static const char* kPacingModeNames[kPacingModes] = {"vsync", "adaptive", "uncapped", "limited"};
+
+static double TicksToMs(const FramePacer& p, uint64_t ticks) {
+    return ticks * 1000.0 / p.frequency;
+}
+
+// Retires the oldest frame in flight once its fence has signaled, waiting
+// up to timeoutNs. Returns false if it's still running.
+static bool RetireOldest(FramePacer& p, GLuint64 timeoutNs) {
+    PacedFrame& f = p.frames[p.head];
+    GLenum result = glClientWaitSync(f.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "FramePacer: glClientWaitSync failed\n";
+    } else {
+        p.lastLatencyMs = TicksToMs(p, SDL_GetPerformanceCounter() - f.sampled);
+        PushFrameTime(p.latency[(int)f.mode], p.lastLatencyMs);
+    }
+    glDeleteSync(f.fence);
+    f = PacedFrame{};
+    p.head = (p.head + 1) % kFramePacerMaxFences;
+    p.count--;
+    return true;
+}
+
+static void WaitOldest(FramePacer& p) {
+    while (!RetireOldest(p, 1000000)) { // 1ms
+    }
+}
+
+// Sleeps most of the way to the deadline and spins the rest. While frames
+// are in flight the sleeping is done in glClientWaitSync on the oldest, so
+// its completion time is caught as it happens.
+static void WaitForDeadline(FramePacer& p) {
+    uint64_t interval = (uint64_t)(p.frequency / p.targetFps);
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (p.deadline == 0 || now > p.deadline + interval) {
+        // First frame, or so far behind that catching up would mean a burst of frames
+        p.deadline = now;
+    }
+
+    uint64_t spin = (uint64_t)(p.spinMs * p.frequency / 1000.0);
+    while (p.deadline > now + spin) {
+        uint64_t sleepNs = (p.deadline - now - spin) * SDL_NS_PER_SECOND / p.frequency;
+        if (p.count > 0) {
+            RetireOldest(p, sleepNs);
+        } else {
+            SDL_DelayNS(sleepNs);
+        }
+        now = SDL_GetPerformanceCounter();
+    }
+    while (SDL_GetPerformanceCounter() < p.deadline) {
+    }
+    p.deadline += interval;
+}
+
+const char* PacingModeName(PacingMode mode) {
+    return kPacingModeNames[(int)mode];
+}
+
+bool ParsePacingMode(const char* name, PacingMode& mode) {
+    for (int i = 0; i < kPacingModes; i++) {
+        if (std::strcmp(name, kPacingModeNames[i]) == 0) {
+            mode = (PacingMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void InitFramePacer(FramePacer& p, PacingMode mode, double refreshRate) {
+    p.frequency = SDL_GetPerformanceFrequency();
+    for (FrameTimeRing& ring : p.latency) ResetFrameTimes(ring, 1000.0 / refreshRate);
+    SetPacingMode(p, mode);
+}
+
+void CleanupFramePacer(FramePacer& p) {
+    while (p.count > 0) WaitOldest(p);
+    p.head = 0;
+}
+
+bool SetPacingMode(FramePacer& p, PacingMode mode) {
+    p.deadline = 0;
+    p.mode = mode;
+    switch (mode) {
+        case PacingMode::Vsync:
+            SDL_GL_SetSwapInterval(1);
+            return true;
+        case PacingMode::AdaptiveVsync:
+            if (p.adaptiveSupported && SDL_GL_SetSwapInterval(-1)) return true;
+            if (p.adaptiveSupported) {
+                std::cerr << "FramePacer: adaptive vsync unsupported, using vsync\n";
+                p.adaptiveSupported = false;
+            }
+            SDL_GL_SetSwapInterval(1);
+            p.mode = PacingMode::Vsync;
+            return false;
+        default:
+            SDL_GL_SetSwapInterval(0);
+            return true;
+    }
+}
+
+void PacerBeginFrame(FramePacer& p, int queued) {
+    ZoneScopedN("Frame pacing");
+    if (p.mode == PacingMode::Limited && p.targetFps > 0.0) WaitForDeadline(p);
+
+    // Collect whatever finished since last frame, then hold the CPU back
+    // until there's room under the cap
+    while (p.count > 0 && RetireOldest(p, 0)) {
+    }
+    int cap = p.maxFramesInFlight > 0 ? p.maxFramesInFlight : kFramePacerMaxFences;
+    cap = std::max(cap - queued, 1);
+    if (p.count >= cap) {
+        ZoneScopedN("Frames in flight wait");
+        p.capWaits++;
+        while (p.count >= cap) WaitOldest(p);
+    }
+    p.sampled = SDL_GetPerformanceCounter();
+}
+
+void PacerEndFrame(FramePacer& p, uint64_t sampled) {
+    if (p.count == kFramePacerMaxFences) WaitOldest(p); // Only without a cap, and then rarely
+    PacedFrame& f = p.frames[(p.head + p.count) % kFramePacerMaxFences];
+    f.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    f.sampled = sampled ? sampled : p.sampled;
+    f.mode = p.mode;
+    p.count++;
+}
+
+void PrintPacingStats(const FramePacer& p) {
+    std::cout << std::fixed << std::setprecision(3) << "Pacing: " << PacingModeName(p.mode)
+              << ", max " << p.maxFramesInFlight << " frames in flight, " << p.capWaits << " cap waits\n";
+    for (int i = 0; i < kPacingModes; i++) {
+        FrameTimeSummary s = SummarizeFrameTimes(p.latency[i]);
+        if (s.frames == 0) continue;
+        std::cout << "  " << kPacingModeNames[i] << " latency: p50 " << s.p50Ms << " ms, p95 " << s.p95Ms
+                  << ", p99 " << s.p99Ms << ", max " << s.maxMs << " (" << s.frames << " frames)\n";
+    }
+}
@@ -0,0 +1,91 @@
+// src/FrameTimes.cpp
+
+#include "FrameTimes.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Nearest rank on sorted samples.
+static double Percentile(const float* sorted, size_t count, double p) {
+    size_t rank = (size_t)(p * (count - 1) + 0.5);
+    return sorted[std::min(rank, count - 1)];
+}
+
+void ResetFrameTimes(FrameTimeRing& ring, double budgetMs) {
+    ring.budgetMs = budgetMs;
+    ring.count.store(0, std::memory_order_relaxed);
+    ring.overBudget.store(0, std::memory_order_relaxed);
+}
+
+void PushFrameTime(FrameTimeRing& ring, double ms) {
+    uint64_t n = ring.count.load(std::memory_order_relaxed);
+    ring.samples[n & (kFrameTimeCapacity - 1)].store((float)ms, std::memory_order_relaxed);
+    if (ms > ring.budgetMs) ring.overBudget.fetch_add(1, std::memory_order_relaxed);
+    ring.count.store(n + 1, std::memory_order_release);
+}
+
+size_t CopyFrameTimes(const FrameTimeRing& ring, float* out, size_t max) {
+    uint64_t n = ring.count.load(std::memory_order_acquire);
+    size_t available = (size_t)std::min<uint64_t>(n, kFrameTimeCapacity);
+    size_t count = std::min(available, max);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t index = n - count + i;
+        out[i] = ring.samples[index & (kFrameTimeCapacity - 1)].load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+// Fills in everything but the budget fields, sorting samples in place.
+static void Summarize(FrameTimeSummary& s, float* samples, size_t count) {
+    if (count == 0) return;
+
+    double total = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        float ms = samples[i];
+        total += ms;
+        if (ms > s.budgetMs) s.overBudget++;
+        int bucket = s.bucketMs > 0.0 ? (int)(ms / s.bucketMs) : 0;
+        s.histogram[std::min(bucket, kFrameTimeBuckets - 1)]++;
+    }
+    std::sort(samples, samples + count);
+
+    s.frames = (uint32_t)count;
+    s.avgMs = total / count;
+    s.p50Ms = Percentile(samples, count, 0.50);
+    s.p95Ms = Percentile(samples, count, 0.95);
+    s.p99Ms = Percentile(samples, count, 0.99);
+    s.maxMs = samples[count - 1];
+}
+
+FrameTimeSummary SummarizeFrameTimes(const FrameTimeRing& ring, int window) {
+    FrameTimeSummary s;
+    s.budgetMs = ring.budgetMs;
+    s.bucketMs = ring.budgetMs / 8.0;
+    s.overBudgetTotal = ring.overBudget.load(std::memory_order_relaxed);
+
+    // On the stack, so summarizing every frame doesn't allocate
+    float sorted[kFrameTimeCapacity];
+    window = std::max(0, std::min(window, kFrameTimeCapacity));
+    size_t count = CopyFrameTimes(ring, sorted, (size_t)window);
+    Summarize(s, sorted, count);
+    return s;
+}
+
+FrameTimeSummary SummarizeFrameTimeSamples(const float* samples, size_t count, double budgetMs) {
+    FrameTimeSummary s;
+    s.budgetMs = budgetMs;
+    s.bucketMs = budgetMs / 8.0;
+    std::vector<float> sorted(samples, samples + count);
+    Summarize(s, sorted.data(), count);
+    s.overBudgetTotal = s.overBudget;
+    return s;
+}
+
+void PrintFrameTimes(const FrameTimeSummary& s) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "Frame times: " << s.frames << " frames, avg " << s.avgMs << " ms, p50 " << s.p50Ms
+              << ", p95 " << s.p95Ms << ", p99 " << s.p99Ms << ", max " << s.maxMs << "; "
+              << s.overBudget << " over the " << s.budgetMs << " ms budget\n";
+}
@@ -0,0 +1,292 @@
+// src/GLResources.cpp
+
+#include "GLResources.h"
+#include "GLState.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <tracy/Tracy.hpp>
+
+static const uint32_t kGLHandleIndexMask = (1u << kGLHandleIndexBits) - 1;
+static const uint32_t kGLHandleMaxGeneration = (1u << kGLHandleGenerationBits) - 1;
+static const uint32_t kNotLive = 0xFFFFFFFFu;
+static const int kMaxStaleReports = 8; // Then only counted
+
+struct GLResourcePool {
+    // Per slot, indexed by handle
+    std::vector<uint16_t> generations;
+    std::vector<uint32_t> denseIndex; // kNotLive for free slots
+    std::vector<uint32_t> freeSlots;
+    // Per live object, packed
+    std::vector<GLuint> names;
+    std::vector<uint32_t> slots; // Back to the slot, for swap-remove
+    std::vector<uint64_t> bytes;
+    std::vector<const char*> labels;
+};
+
+struct GLRetired {
+    GLResourceType type;
+    GLuint name;
+};
+
+// Objects retired during one frame, deleted when fence passes
+struct GLRetireFrame {
+    GLsync fence = nullptr;
+    std::vector<GLRetired> objects;
+};
+
+struct GLResourceRegistry {
+    GLResourcePool pools[kGLResourceTypes];
+    std::vector<GLRetired> current; // Retired this frame, not fenced yet
+    GLRetireFrame frames[kGLRetireFrames];
+    int oldest = 0; // Ring of fenced frames
+    int fenced = 0;
+    GLResourceStats stats;
+};
+
+static GLResourceRegistry s_registry;
+
+const char* GLResourceTypeName(GLResourceType type) {
+    switch (type) {
+        case GLResourceType::Buffer: return "Buffer";
+        case GLResourceType::VertexArray: return "VertexArray";
+        case GLResourceType::Texture: return "Texture";
+        case GLResourceType::Renderbuffer: return "Renderbuffer";
+        case GLResourceType::Framebuffer: return "Framebuffer";
+        case GLResourceType::Program: return "Program";
+        default: return "Unknown";
+    }
+}
+
+static GLuint GenName(GLResourceType type) {
+    GLuint name = 0;
+    switch (type) {
+        case GLResourceType::Buffer: glGenBuffers(1, &name); break;
+        case GLResourceType::VertexArray: glGenVertexArrays(1, &name); break;
+        case GLResourceType::Texture: glGenTextures(1, &name); break;
+        case GLResourceType::Renderbuffer: glGenRenderbuffers(1, &name); break;
+        case GLResourceType::Framebuffer: glGenFramebuffers(1, &name); break;
+        case GLResourceType::Program: name = glCreateProgram(); break;
+        default: break;
+    }
+    return name;
+}
+
+// Through GLState where it tracks the binding, so a recycled name isn't
+// taken for the deleted object
+static void DeleteName(GLResourceType type, GLuint name) {
+    switch (type) {
+        case GLResourceType::Buffer: StateDeleteBuffer(name); break;
+        case GLResourceType::VertexArray: StateDeleteVertexArray(name); break;
+        case GLResourceType::Texture: StateDeleteTexture(name); break;
+        case GLResourceType::Renderbuffer: glDeleteRenderbuffers(1, &name); break;
+        case GLResourceType::Framebuffer: StateDeleteFramebuffer(name); break;
+        case GLResourceType::Program: StateDeleteProgram(name); break;
+        default: break;
+    }
+    s_registry.stats.deleted++;
+}
+
+static uint32_t MakeBits(uint32_t slot, uint32_t generation) {
+    return (generation << kGLHandleIndexBits) | slot;
+}
+
+// Dense index of the object bits refers to, kNotLive for null and stale handles.
+static uint32_t Lookup(const GLResourcePool& pool, uint32_t bits) {
+    if (bits == 0) return kNotLive;
+    uint32_t slot = bits & kGLHandleIndexMask;
+    uint32_t generation = bits >> kGLHandleIndexBits;
+    if (slot >= pool.generations.size() || pool.generations[slot] != generation) return kNotLive;
+    return pool.denseIndex[slot];
+}
+
+static void ReportStale(GLResourceType type, uint32_t bits) {
+    if (s_registry.stats.staleLookups++ >= kMaxStaleReports) return;
+    std::cerr << "GLResources: stale " << GLResourceTypeName(type) << " handle (slot "
+              << (bits & kGLHandleIndexMask) << ", generation " << (bits >> kGLHandleIndexBits) << ")\n";
+}
+
+uint32_t AdoptGLObject(GLResourceType type, GLuint name, const char* label) {
+    if (!name) return 0;
+    GLResourcePool& pool = s_registry.pools[(int)type];
+    uint32_t slot;
+    if (!pool.freeSlots.empty()) {
+        slot = pool.freeSlots.back();
+        pool.freeSlots.pop_back();
+    } else {
+        slot = (uint32_t)pool.generations.size();
+        if (slot > kGLHandleIndexMask) {
+            std::cerr << "GLResources: out of " << GLResourceTypeName(type) << " handles\n";
+            std::exit(-1);
+        }
+        pool.generations.push_back(1);
+        pool.denseIndex.push_back(kNotLive);
+    }
+
+    pool.denseIndex[slot] = (uint32_t)pool.names.size();
+    pool.names.push_back(name);
+    pool.slots.push_back(slot);
+    pool.bytes.push_back(0);
+    pool.labels.push_back(label);
+    s_registry.stats.live[(int)type]++;
+    return MakeBits(slot, pool.generations[slot]);
+}
+
+uint32_t CreateGLObject(GLResourceType type, const char* label) {
+    GLuint name = GenName(type);
+    if (!name) {
+        std::cerr << "GLResources: creating a " << GLResourceTypeName(type) << " failed\n";
+        return 0;
+    }
+    return AdoptGLObject(type, name, label);
+}
+
+GLuint ResolveGLObject(GLResourceType type, uint32_t bits) {
+    const GLResourcePool& pool = s_registry.pools[(int)type];
+    uint32_t dense = Lookup(pool, bits);
+    if (dense == kNotLive) {
+        if (bits) ReportStale(type, bits);
+        return 0;
+    }
+    return pool.names[dense];
+}
+
+bool IsGLObjectLive(GLResourceType type, uint32_t bits) {
+    return Lookup(s_registry.pools[(int)type], bits) != kNotLive;
+}
+
+void SetGLObjectBytes(GLResourceType type, uint32_t bits, uint64_t bytes) {
+    GLResourcePool& pool = s_registry.pools[(int)type];
+    uint32_t dense = Lookup(pool, bits);
+    if (dense == kNotLive) return;
+    GLResourceStats& stats = s_registry.stats;
+    stats.bytes[(int)type] = stats.bytes[(int)type] - pool.bytes[dense] + bytes;
+    pool.bytes[dense] = bytes;
+}
+
+void RetireGLName(GLResourceType type, GLuint name) {
+    if (!name) return;
+    s_registry.current.push_back(GLRetired{type, name});
+    s_registry.stats.retiredPending++;
+}
+
+void DestroyGLObject(GLResourceType type, uint32_t bits) {
+    GLResourcePool& pool = s_registry.pools[(int)type];
+    uint32_t dense = Lookup(pool, bits);
+    if (dense == kNotLive) {
+        if (bits) ReportStale(type, bits);
+        return;
+    }
+    RetireGLName(type, pool.names[dense]);
+    GLResourceStats& stats = s_registry.stats;
+    stats.live[(int)type]--;
+    stats.bytes[(int)type] -= pool.bytes[dense];
+
+    // Swap-remove from the packed arrays
+    uint32_t slot = bits & kGLHandleIndexMask;
+    uint32_t last = (uint32_t)pool.names.size() - 1;
+    if (dense != last) {
+        pool.names[dense] = pool.names[last];
+        pool.slots[dense] = pool.slots[last];
+        pool.bytes[dense] = pool.bytes[last];
+        pool.labels[dense] = pool.labels[last];
+        pool.denseIndex[pool.slots[dense]] = dense;
+    }
+    pool.names.pop_back();
+    pool.slots.pop_back();
+    pool.bytes.pop_back();
+    pool.labels.pop_back();
+
+    // New generation invalidates every copy of the handle; 0 is skipped
+    // so no handle is ever all zero
+    uint32_t generation = pool.generations[slot] + 1;
+    pool.generations[slot] = (uint16_t)(generation > kGLHandleMaxGeneration ? 1 : generation);
+    pool.denseIndex[slot] = kNotLive;
+    pool.freeSlots.push_back(slot);
+}
+
+static void DeleteFrame(GLRetireFrame& frame) {
+    for (const GLRetired& r : frame.objects) DeleteName(r.type, r.name);
+    s_registry.stats.retiredPending -= (uint32_t)frame.objects.size();
+    frame.objects.clear();
+    glDeleteSync(frame.fence);
+    frame.fence = nullptr;
+}
+
+void EndGLResourceFrame() {
+    ZoneScoped;
+    GLResourceRegistry& reg = s_registry;
+    if (!reg.current.empty()) {
+        if (reg.fenced == kGLRetireFrames) {
+            // Ring full: the oldest frame has to go now
+            ZoneScopedN("Retire fence wait");
+            GLRetireFrame& oldest = reg.frames[reg.oldest];
+            while (glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+            }
+            DeleteFrame(oldest);
+            reg.oldest = (reg.oldest + 1) % kGLRetireFrames;
+            reg.fenced--;
+            reg.stats.retireStalls++;
+        }
+        GLRetireFrame& frame = reg.frames[(reg.oldest + reg.fenced) % kGLRetireFrames];
+        frame.objects.swap(reg.current); // Both keep their capacity
+        frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        reg.fenced++;
+    }
+
+    // Oldest first; fences pass in order
+    while (reg.fenced > 0) {
+        GLRetireFrame& oldest = reg.frames[reg.oldest];
+        GLenum result = glClientWaitSync(oldest.fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) break;
+        DeleteFrame(oldest);
+        reg.oldest = (reg.oldest + 1) % kGLRetireFrames;
+        reg.fenced--;
+    }
+}
+
+void CleanupGLResources() {
+    GLResourceRegistry& reg = s_registry;
+    glFinish();
+    for (; reg.fenced > 0; reg.fenced--) {
+        DeleteFrame(reg.frames[reg.oldest]);
+        reg.oldest = (reg.oldest + 1) % kGLRetireFrames;
+    }
+    reg.oldest = 0;
+    for (const GLRetired& r : reg.current) DeleteName(r.type, r.name);
+    reg.current.clear();
+    reg.stats.retiredPending = 0;
+
+    for (int t = 0; t < kGLResourceTypes; t++) {
+        GLResourcePool& pool = reg.pools[t];
+        for (size_t i = 0; i < pool.names.size(); i++) {
+            std::cerr << "GLResources: leaked " << GLResourceTypeName((GLResourceType)t) << " "
+                      << (pool.labels[i] ? pool.labels[i] : "(unlabeled)") << "\n";
+            DeleteName((GLResourceType)t, pool.names[i]);
+        }
+        pool = GLResourcePool{};
+        reg.stats.live[t] = 0;
+        reg.stats.bytes[t] = 0;
+    }
+}
+
+GLResourceStats GetGLResourceStats() {
+    return s_registry.stats;
+}
+
+void PrintGLResourceStats() {
+    const GLResourceStats& stats = s_registry.stats;
+    std::cout << "GL resources:";
+    uint32_t live = 0;
+    for (int t = 0; t < kGLResourceTypes; t++) {
+        live += stats.live[t];
+        if (!stats.live[t]) continue;
+        std::cout << " " << stats.live[t] << " " << GLResourceTypeName((GLResourceType)t);
+        if (stats.bytes[t]) std::cout << " (" << stats.bytes[t] / 1024.0 << " KB)";
+    }
+    if (!live) std::cout << " none live";
+    std::cout << "; " << stats.deleted << " deleted, " << stats.retiredPending << " waiting on fences, "
+              << stats.staleLookups << " stale lookups, " << stats.retireStalls << " retire stalls\n";
+}
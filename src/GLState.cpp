@@ -0,0 +1,293 @@
+// src/GLState.cpp
+
+#include "GLState.h"
+
+static const GLuint kUnknown = 0xFFFFFFFFu;
+static const int kMaxTextureUnits = 32;
+
+enum BufferSlot {
+    kArrayBuffer,
+    kElementBuffer,
+    kUniformBuffer,
+    kCopyReadBuffer,
+    kCopyWriteBuffer,
+    kPixelPackBuffer,
+    kPixelUnpackBuffer,
+    kDrawIndirectBuffer,
+    kShaderStorageBuffer,
+    kBufferSlotCount
+};
+
+enum TextureSlot {
+    kTexture2D,
+    kTexture2DArray,
+    kTexture3D,
+    kTextureCube,
+    kTextureBuffer,
+    kTextureSlotCount
+};
+
+enum CapSlot {
+    kCapBlend,
+    kCapDepthTest,
+    kCapCullFace,
+    kCapScissorTest,
+    kCapSlotCount
+};
+
+struct GLStateCache;
+static void ResetCache(GLStateCache& c);
+
+struct GLStateCache {
+    // Static storage starts zeroed, which would look like "0 is bound"
+    GLStateCache() { ResetCache(*this); }
+
+    GLuint program;
+    GLuint vao;
+    GLuint buffers[kBufferSlotCount];
+    GLuint drawFramebuffer;
+    GLuint readFramebuffer;
+    GLuint activeUnit;
+    GLuint textures[kMaxTextureUnits][kTextureSlotCount];
+    GLuint caps[kCapSlotCount]; // kUnknown, 0 or 1
+    GLenum blend[4];
+    GLenum blendEquation;
+    GLenum depthFunc;
+    GLuint depthMask;
+    GLint viewport[4];
+    GLStateCounters counters;
+};
+
+static GLStateCache s_state;
+
+static int BufferSlotFor(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER: return kArrayBuffer;
+        case GL_ELEMENT_ARRAY_BUFFER: return kElementBuffer;
+        case GL_UNIFORM_BUFFER: return kUniformBuffer;
+        case GL_COPY_READ_BUFFER: return kCopyReadBuffer;
+        case GL_COPY_WRITE_BUFFER: return kCopyWriteBuffer;
+        case GL_PIXEL_PACK_BUFFER: return kPixelPackBuffer;
+        case GL_PIXEL_UNPACK_BUFFER: return kPixelUnpackBuffer;
+        case GL_DRAW_INDIRECT_BUFFER: return kDrawIndirectBuffer;
+        case GL_SHADER_STORAGE_BUFFER: return kShaderStorageBuffer;
+        default: return -1;
+    }
+}
+
+static int TextureSlotFor(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D: return kTexture2D;
+        case GL_TEXTURE_2D_ARRAY: return kTexture2DArray;
+        case GL_TEXTURE_3D: return kTexture3D;
+        case GL_TEXTURE_CUBE_MAP: return kTextureCube;
+        case GL_TEXTURE_BUFFER: return kTextureBuffer;
+        default: return -1;
+    }
+}
+
+static int CapSlotFor(GLenum cap) {
+    switch (cap) {
+        case GL_BLEND: return kCapBlend;
+        case GL_DEPTH_TEST: return kCapDepthTest;
+        case GL_CULL_FACE: return kCapCullFace;
+        case GL_SCISSOR_TEST: return kCapScissorTest;
+        default: return -1;
+    }
+}
+
+// True when value differs; stores it and counts the call either way.
+template <typename T>
+static bool Changed(T& cached, T value) {
+    if (cached == value) {
+        s_state.counters.elided++;
+        return false;
+    }
+    cached = value;
+    s_state.counters.issued++;
+    return true;
+}
+
+static void ResetCache(GLStateCache& c) {
+    c.program = kUnknown;
+    c.vao = kUnknown;
+    for (GLuint& b : c.buffers) b = kUnknown;
+    c.drawFramebuffer = kUnknown;
+    c.readFramebuffer = kUnknown;
+    c.activeUnit = kUnknown;
+    for (auto& unit : c.textures) {
+        for (GLuint& t : unit) t = kUnknown;
+    }
+    for (GLuint& cap : c.caps) cap = kUnknown;
+    for (GLenum& b : c.blend) b = kUnknown;
+    c.blendEquation = kUnknown;
+    c.depthFunc = kUnknown;
+    c.depthMask = kUnknown;
+    for (GLint& v : c.viewport) v = -1;
+}
+
+void InvalidateGLState() {
+    ResetCache(s_state);
+}
+
+void StateUseProgram(GLuint program) {
+    if (Changed(s_state.program, program)) glUseProgram(program);
+}
+
+void StateBindVertexArray(GLuint vao) {
+    if (Changed(s_state.vao, vao)) {
+        glBindVertexArray(vao);
+        s_state.buffers[kElementBuffer] = kUnknown; // Belongs to the VAO
+    }
+}
+
+void StateBindBuffer(GLenum target, GLuint buffer) {
+    int slot = BufferSlotFor(target);
+    if (slot < 0) {
+        s_state.counters.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (Changed(s_state.buffers[slot], buffer)) glBindBuffer(target, buffer);
+}
+
+void StateBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    int slot = BufferSlotFor(target);
+    if (slot >= 0) s_state.buffers[slot] = buffer;
+    s_state.counters.issued++;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void StateBindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int slot = TextureSlotFor(target);
+    if (unit >= (GLuint)kMaxTextureUnits || slot < 0) {
+        s_state.counters.issued += 2;
+        s_state.activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        return;
+    }
+    if (s_state.textures[unit][slot] == texture) {
+        s_state.counters.elided++;
+        return;
+    }
+    if (Changed(s_state.activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+    s_state.textures[unit][slot] = texture;
+    s_state.counters.issued++;
+    glBindTexture(target, texture);
+}
+
+void StateBindFramebuffer(GLenum target, GLuint framebuffer) {
+    if (target == GL_DRAW_FRAMEBUFFER) {
+        if (Changed(s_state.drawFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+    } else if (target == GL_READ_FRAMEBUFFER) {
+        if (Changed(s_state.readFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+    } else if (s_state.drawFramebuffer == framebuffer && s_state.readFramebuffer == framebuffer) {
+        s_state.counters.elided++;
+    } else {
+        s_state.drawFramebuffer = framebuffer;
+        s_state.readFramebuffer = framebuffer;
+        s_state.counters.issued++;
+        glBindFramebuffer(target, framebuffer);
+    }
+}
+
+void StateEnable(GLenum cap, bool enabled) {
+    int slot = CapSlotFor(cap);
+    if (slot >= 0 && !Changed(s_state.caps[slot], (GLuint)enabled)) return;
+    if (slot < 0) s_state.counters.issued++;
+    if (enabled) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void StateBlendFunc(GLenum src, GLenum dst) {
+    StateBlendFuncSeparate(src, dst, src, dst);
+}
+
+void StateBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    GLenum* b = s_state.blend;
+    if (b[0] == srcRGB && b[1] == dstRGB && b[2] == srcAlpha && b[3] == dstAlpha) {
+        s_state.counters.elided++;
+        return;
+    }
+    b[0] = srcRGB;
+    b[1] = dstRGB;
+    b[2] = srcAlpha;
+    b[3] = dstAlpha;
+    s_state.counters.issued++;
+    glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+void StateBlendEquation(GLenum mode) {
+    if (Changed(s_state.blendEquation, mode)) glBlendEquation(mode);
+}
+
+void StateDepthFunc(GLenum func) {
+    if (Changed(s_state.depthFunc, func)) glDepthFunc(func);
+}
+
+void StateDepthMask(bool write) {
+    if (Changed(s_state.depthMask, (GLuint)write)) glDepthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void StateViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    GLint* v = s_state.viewport;
+    if (v[0] == x && v[1] == y && v[2] == width && v[3] == height) {
+        s_state.counters.elided++;
+        return;
+    }
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+    s_state.counters.issued++;
+    glViewport(x, y, width, height);
+}
+
+void StateDeleteProgram(GLuint program) {
+    if (s_state.program == program) s_state.program = kUnknown;
+    glDeleteProgram(program);
+}
+
+void StateDeleteVertexArray(GLuint vao) {
+    if (s_state.vao == vao) {
+        // Deleting the bound VAO reverts the binding to 0
+        s_state.vao = 0;
+        s_state.buffers[kElementBuffer] = kUnknown;
+    }
+    glDeleteVertexArrays(1, &vao);
+}
+
+void StateDeleteBuffer(GLuint buffer) {
+    for (GLuint& b : s_state.buffers) {
+        if (b == buffer) b = 0;
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void StateDeleteTexture(GLuint texture) {
+    for (auto& unit : s_state.textures) {
+        for (GLuint& t : unit) {
+            if (t == texture) t = 0;
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void StateDeleteFramebuffer(GLuint framebuffer) {
+    // Deleting a bound framebuffer reverts the binding to 0
+    if (s_state.drawFramebuffer == framebuffer) s_state.drawFramebuffer = 0;
+    if (s_state.readFramebuffer == framebuffer) s_state.readFramebuffer = 0;
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+const GLStateCounters& GetGLStateCounters() {
+    return s_state.counters;
+}
+
+void ResetGLStateCounters() {
+    s_state.counters = GLStateCounters{};
+}
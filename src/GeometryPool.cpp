@@ -0,0 +1,241 @@
+// src/GeometryPool.cpp
+
+#include "GeometryPool.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include <tracy/Tracy.hpp>
+
+static const char* kVertexLabel = "Geometry vertices";
+static const char* kIndexLabel = "Geometry indices";
+
+// One side of the pool: the vertex buffer or the index buffer.
+struct GeometrySide {
+    RangeAllocator& allocator;
+    BufferHandle& buffer;
+    size_t unitBytes;
+    const char* label;
+    bool vertices;
+};
+
+static GeometrySide VertexSide(GeometryPool& pool) {
+    return GeometrySide{pool.vertices, pool.vertexBuffer, (size_t)pool.stride, kVertexLabel, true};
+}
+
+static GeometrySide IndexSide(GeometryPool& pool) {
+    return GeometrySide{pool.indices, pool.indexBuffer, sizeof(uint32_t), kIndexLabel, false};
+}
+
+// Copies through GL_COPY_WRITE_BUFFER and GL_COPY_READ_BUFFER, so the
+// element buffer binding of whatever VAO is bound is left alone
+static BufferHandle NewBuffer(const char* label, size_t bytes) {
+    BufferHandle buffer = CreateGLResource<GLResourceType::Buffer>(label);
+    StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(buffer));
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STATIC_DRAW);
+    SetGLResourceBytes(buffer, bytes);
+    return buffer;
+}
+
+// The old buffer is deleted once the frames drawing from it are done.
+static void ReplaceBuffer(GeometrySide& side, BufferHandle buffer) {
+    if (!side.vertices) ReleaseVertexArrays(side.buffer);
+    DestroyGLResource(side.buffer);
+    side.buffer = buffer;
+}
+
+static void Grow(GeometryPool& pool, GeometrySide side, uint32_t needed) {
+    ZoneScopedN("Geometry grow");
+    RangeAllocator& a = side.allocator;
+    uint32_t capacity = std::max(a.capacity * 2, a.capacity + needed);
+    BufferHandle buffer = NewBuffer(side.label, capacity * side.unitBytes);
+    size_t bytes = a.capacity * side.unitBytes;
+    StateBindBuffer(GL_COPY_READ_BUFFER, GLName(side.buffer));
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytes);
+    GrowRangeAllocator(a, capacity);
+    ReplaceBuffer(side, buffer);
+    pool.stats.grows++;
+    pool.stats.bytesMoved += bytes;
+}
+
+struct LiveRange {
+    uint32_t offset;
+    uint32_t range;
+};
+
+// Re-allocates the live ranges in offset order from an empty allocator,
+// which places them back to back from 0, and copies them over.
+static void Pack(GeometryPool& pool, GeometrySide side) {
+    ZoneScopedN("Geometry defragment");
+    RangeAllocator& a = side.allocator;
+    std::vector<LiveRange> live;
+    for (uint32_t i = 0; i < pool.ranges.size(); i++) {
+        const GeometryRange& g = pool.ranges[i];
+        if (g.vertexNode == kRangeNone) continue;
+        live.push_back({a.nodes[side.vertices ? g.vertexNode : g.indexNode].offset, i});
+    }
+    std::sort(live.begin(), live.end(), [](const LiveRange& x, const LiveRange& y) { return x.offset < y.offset; });
+
+    RangeAllocator packed;
+    InitRangeAllocator(packed, a.capacity);
+    BufferHandle buffer = NewBuffer(side.label, a.capacity * side.unitBytes);
+    StateBindBuffer(GL_COPY_READ_BUFFER, GLName(side.buffer));
+
+    // Ranges that were already adjacent go over in one copy
+    size_t readOffset = 0, writeOffset = 0, runBytes = 0;
+    for (const LiveRange& l : live) {
+        GeometryRange& g = pool.ranges[l.range];
+        uint32_t& node = side.vertices ? g.vertexNode : g.indexNode;
+        const RangeNode& old = a.nodes[node];
+        RangeAllocation moved = RangeAlloc(packed, old.size);
+        size_t from = old.offset * side.unitBytes;
+        size_t to = moved.offset * side.unitBytes;
+        size_t bytes = old.size * side.unitBytes;
+        if (runBytes && readOffset + runBytes == from && writeOffset + runBytes == to) {
+            runBytes += bytes;
+        } else {
+            if (runBytes) {
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, runBytes);
+                pool.stats.bytesMoved += runBytes;
+            }
+            readOffset = from;
+            writeOffset = to;
+            runBytes = bytes;
+        }
+        node = moved.node;
+        if (side.vertices) {
+            g.baseVertex = (GLint)moved.offset;
+        } else {
+            g.firstIndex = moved.offset;
+        }
+    }
+    if (runBytes) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, runBytes);
+        pool.stats.bytesMoved += runBytes;
+    }
+
+    a = std::move(packed);
+    ReplaceBuffer(side, buffer);
+}
+
+static RangeAllocation AllocSide(GeometryPool& pool, GeometrySide side, uint32_t size) {
+    RangeAllocator& a = side.allocator;
+    RangeAllocation r = RangeAlloc(a, size);
+    if (r.node != kRangeNone) return r;
+
+    if (RangePackPays(a, size)) {
+        Pack(pool, side);
+        pool.stats.defrags++;
+    } else {
+        Grow(pool, side, size);
+    }
+    // Packed, the free space is one range at the end; grown, at least size
+    // was appended to it. Either way this fits.
+    return RangeAlloc(a, size);
+}
+
+static void Upload(GeometrySide side, uint32_t offset, const void* data, uint32_t count) {
+    StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(side.buffer));
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset * side.unitBytes, count * side.unitBytes, data);
+}
+
+void InitGeometryPool(GeometryPool& pool, const char* name, GLsizei stride, uint32_t vertexCapacity,
+                      uint32_t indexCapacity) {
+    pool.name = name;
+    pool.stride = stride;
+    pool.stats = GeometryPoolStats{};
+    InitRangeAllocator(pool.vertices, vertexCapacity);
+    InitRangeAllocator(pool.indices, indexCapacity);
+    pool.vertexBuffer = NewBuffer(kVertexLabel, (size_t)vertexCapacity * stride);
+    pool.indexBuffer = NewBuffer(kIndexLabel, (size_t)indexCapacity * sizeof(uint32_t));
+}
+
+void CleanupGeometryPool(GeometryPool& pool) {
+    ReleaseVertexArrays(pool.indexBuffer);
+    DestroyGLResource(pool.vertexBuffer);
+    DestroyGLResource(pool.indexBuffer);
+    InitRangeAllocator(pool.vertices, 0);
+    InitRangeAllocator(pool.indices, 0);
+    pool.ranges.clear();
+    pool.freeRanges.clear();
+    pool.sequentialIndices.clear();
+}
+
+GeometryHandle AddGeometry(GeometryPool& pool, const void* vertices, uint32_t vertexCount,
+                           const uint32_t* indices, uint32_t indexCount) {
+    if (vertexCount == 0 || (indices && indexCount == 0)) {
+        std::cerr << "AddGeometry: empty mesh in " << pool.name << "\n";
+        return GeometryHandle{};
+    }
+    if (!indices) {
+        pool.sequentialIndices.resize(vertexCount);
+        std::iota(pool.sequentialIndices.begin(), pool.sequentialIndices.end(), 0u);
+        indices = pool.sequentialIndices.data();
+        indexCount = vertexCount;
+    }
+
+    // Before the slot is claimed, so a defragment doesn't see it half made
+    RangeAllocation v = AllocSide(pool, VertexSide(pool), vertexCount);
+    RangeAllocation i = AllocSide(pool, IndexSide(pool), indexCount);
+    Upload(VertexSide(pool), v.offset, vertices, vertexCount);
+    Upload(IndexSide(pool), i.offset, indices, indexCount);
+    pool.stats.bytesUploaded += (uint64_t)vertexCount * pool.stride + (uint64_t)indexCount * sizeof(uint32_t);
+
+    uint32_t slot;
+    if (!pool.freeRanges.empty()) {
+        slot = pool.freeRanges.back();
+        pool.freeRanges.pop_back();
+    } else {
+        slot = (uint32_t)pool.ranges.size();
+        pool.ranges.emplace_back();
+    }
+    GeometryRange& g = pool.ranges[slot];
+    g.baseVertex = (GLint)v.offset;
+    g.firstIndex = i.offset;
+    g.indexCount = (GLsizei)indexCount;
+    g.vertexCount = (GLsizei)vertexCount;
+    g.vertexNode = v.node;
+    g.indexNode = i.node;
+    return GeometryHandle{slot + 1};
+}
+
+void FreeGeometry(GeometryPool& pool, GeometryHandle& handle) {
+    if (!handle || handle.index > pool.ranges.size()) return;
+    GeometryRange& g = pool.ranges[handle.index - 1];
+    if (g.vertexNode != kRangeNone) {
+        RangeFree(pool.vertices, g.vertexNode);
+        RangeFree(pool.indices, g.indexNode);
+        g = GeometryRange{};
+        pool.freeRanges.push_back(handle.index - 1);
+    }
+    handle = GeometryHandle{};
+}
+
+const GeometryRange& GetGeometry(const GeometryPool& pool, GeometryHandle handle) {
+    static const GeometryRange kEmpty;
+    if (!handle || handle.index > pool.ranges.size()) return kEmpty;
+    return pool.ranges[handle.index - 1]; // A freed slot is empty too
+}
+
+void BindGeometryPool(const GeometryPool& pool, const VertexFormat& format, uint32_t binding) {
+    BindVertexFormat(format, pool.indexBuffer);
+    BindVertexBuffer(binding, pool.vertexBuffer);
+}
+
+void DefragmentGeometryPool(GeometryPool& pool) {
+    Pack(pool, VertexSide(pool));
+    Pack(pool, IndexSide(pool));
+    pool.stats.defrags++;
+}
+
+void PrintGeometryPoolStats(const GeometryPool& pool) {
+    const RangeAllocator& v = pool.vertices;
+    const RangeAllocator& i = pool.indices;
+    std::cout << "Geometry " << pool.name << ": " << v.allocations << " meshes, vertices "
+              << v.capacity - v.freeUnits << " of " << v.capacity << " (largest free " << LargestFreeRange(v)
+              << "), indices " << i.capacity - i.freeUnits << " of " << i.capacity << " (largest free "
+              << LargestFreeRange(i) << "); " << pool.stats.grows << " grows, " << pool.stats.defrags
+              << " defrags, " << pool.stats.bytesMoved / 1024.0 << " KB moved\n";
+}
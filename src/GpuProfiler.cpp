@@ -0,0 +1,128 @@
+// src/GpuProfiler.cpp
+
+#include "GpuProfiler.h"
+
+#include <iostream>
+
+static const double kGpuAverageWeight = 0.1;
+
+// Returns the index of a query in the frame's pool, creating more as needed.
+static int NextQuery(GpuFrameQueries& f) {
+    if (f.used == (int)f.queries.size()) {
+        size_t grow = f.queries.empty() ? 16 : f.queries.size();
+        f.queries.resize(f.queries.size() + grow);
+        glGenQueries((GLsizei)grow, f.queries.data() + f.used);
+    }
+    return f.used++;
+}
+
+// Turns a recorded frame into timings, or drops it if the GPU isn't done.
+static void ResolveFrame(GpuProfiler& p, GpuFrameQueries& f) {
+    if (!f.pending) return;
+    f.pending = false;
+
+    // Queries complete in order, so the last one issued says it for all
+    GLint available = 0;
+    glGetQueryObjectiv(f.queries[f.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        p.dropped++;
+        return;
+    }
+
+    p.timings.resize(f.scopes.size());
+    for (size_t i = 0; i < f.scopes.size(); i++) {
+        const GpuScopeRecord& s = f.scopes[i];
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(f.queries[s.begin], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(f.queries[s.end], GL_QUERY_RESULT, &end);
+
+        GpuTiming& t = p.timings[i];
+        t.name = s.name;
+        t.parent = s.parent;
+        t.depth = s.depth;
+        t.ms = end > begin ? (end - begin) / 1e6 : 0.0;
+
+        auto it = p.averages.find(t.name);
+        if (it == p.averages.end()) {
+            it = p.averages.emplace(t.name, t.ms).first;
+        } else {
+            it->second += (t.ms - it->second) * kGpuAverageWeight;
+        }
+        t.avgMs = it->second;
+    }
+
+    p.history[p.historyHead] = p.timings.empty() ? 0.0f : (float)p.timings[0].ms;
+    p.historyHead = (p.historyHead + 1) % kGpuProfilerHistory;
+    p.resolved++;
+}
+
+void InitGpuProfiler(GpuProfiler& p) {
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    p.enabled = bits > 0;
+    if (!p.enabled) {
+        std::cerr << "GpuProfiler: GL_TIMESTAMP queries unsupported, GPU timings disabled\n";
+    }
+}
+
+void CleanupGpuProfiler(GpuProfiler& p) {
+    for (GpuFrameQueries& f : p.frames) {
+        if (!f.queries.empty()) glDeleteQueries((GLsizei)f.queries.size(), f.queries.data());
+        f = GpuFrameQueries{};
+    }
+    p.stack.clear();
+    p.timings.clear();
+    p.enabled = false;
+}
+
+void BeginGpuFrame(GpuProfiler& p, const char* name) {
+    if (!p.enabled) return;
+    GpuFrameQueries& f = p.frames[p.frame];
+    ResolveFrame(p, f);
+    f.scopes.clear();
+    f.used = 0;
+    p.stack.clear();
+    PushGpuScope(p, name);
+}
+
+void EndGpuFrame(GpuProfiler& p) {
+    if (!p.enabled) return;
+    while (!p.stack.empty()) PopGpuScope(p);
+    GpuFrameQueries& f = p.frames[p.frame];
+    f.pending = f.used > 0;
+    p.frame = (p.frame + 1) % kGpuProfilerLatency;
+    // Offscreen swaps may not flush, and unflushed queries never complete
+    glFlush();
+}
+
+void PushGpuScope(GpuProfiler& p, const char* name) {
+    if (!p.enabled) return;
+    GpuFrameQueries& f = p.frames[p.frame];
+    GpuScopeRecord s;
+    s.name = name;
+    s.parent = p.stack.empty() ? -1 : p.stack.back();
+    s.depth = (int)p.stack.size();
+    s.begin = NextQuery(f);
+    s.end = s.begin; // Set by the pop
+    glQueryCounter(f.queries[s.begin], GL_TIMESTAMP);
+    p.stack.push_back((int)f.scopes.size());
+    f.scopes.push_back(s);
+}
+
+void PopGpuScope(GpuProfiler& p) {
+    if (!p.enabled) return;
+    if (p.stack.empty()) {
+        std::cerr << "GpuProfiler: PopGpuScope without a matching push\n";
+        return;
+    }
+    GpuFrameQueries& f = p.frames[p.frame];
+    GpuScopeRecord& s = f.scopes[p.stack.back()];
+    p.stack.pop_back();
+    s.end = NextQuery(f);
+    glQueryCounter(f.queries[s.end], GL_TIMESTAMP);
+}
+
+double GpuFrameMs(const GpuProfiler& p) {
+    return p.timings.empty() ? 0.0 : p.timings[0].ms;
+}
@@ -0,0 +1,270 @@
+// src/InstanceRenderer.cpp
+
+#include "InstanceRenderer.h"
+#include "GLState.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+#include <tracy/Tracy.hpp>
+
+// Attribute locations of the instance streams in vertex.glsl
+static const GLuint kInstanceTransform = 2;
+static const GLuint kInstanceColor = 3;
+static const GLuint kInstanceAngle = 4;
+static const GLuint kInstanceIndex = 5; // Indirect path only
+
+// Mesh vertices on binding 0, instance data on binding 1.
+static VertexFormat InstanceVertexFormat(bool indirect) {
+    VertexFormat format = BatchVertexFormat();
+    if (indirect) {
+        // Divisor 1 attributes start at baseInstance, so this yields the SSBO index
+        AddVertexBinding(format, sizeof(GLuint), 1);
+        AddVertexAttrib(format, kInstanceIndex, VertexAttribType::UInt, 1, 0, 1);
+    } else {
+        AddVertexBinding(format, sizeof(InstanceData), 1);
+        AddVertexAttrib(format, kInstanceTransform, VertexAttribType::Float, 4, offsetof(InstanceData, transform), 1);
+        AddVertexAttrib(format, kInstanceColor, VertexAttribType::Float, 4, offsetof(InstanceData, color), 1);
+        AddVertexAttrib(format, kInstanceAngle, VertexAttribType::Float, 1, offsetof(InstanceData, angle), 1);
+    }
+    return format;
+}
+
+static void FlushMesh(InstanceRenderer& r, InstanceMesh& mesh) {
+    if (mesh.instances.empty()) return;
+
+    size_t bytes = mesh.instances.size() * sizeof(InstanceData);
+    StreamAllocation a = StreamAlloc(r.instanceStream, bytes);
+    if (!a.ptr) {
+        std::cerr << "InstanceFlush: stream allocation failed, dropping " << mesh.instances.size()
+                  << " instances\n";
+        StreamCommit(r.instanceStream, a);
+        mesh.instances.clear();
+        return;
+    }
+    std::memcpy(a.ptr, mesh.instances.data(), bytes);
+    StreamCommit(r.instanceStream, a);
+
+    StateUseProgram(r.program);
+    BindGeometryPool(r.geometry, r.format);
+    BindVertexBuffer(1, r.instanceStream.buffer, a.offset);
+
+    GLsizei count = (GLsizei)mesh.instances.size();
+    const GeometryRange& g = GetGeometry(r.geometry, mesh.geometry);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, g.indexCount, GL_UNSIGNED_INT,
+                                      (void*)(g.firstIndex * sizeof(uint32_t)), count, g.baseVertex);
+
+    r.stats.drawCalls++;
+    r.stats.meshDraws++;
+    r.stats.instances += (uint32_t)count;
+    mesh.instances.clear();
+}
+
+// All pending instances in one SSBO range, one command per mesh, one call.
+static void FlushIndirect(InstanceRenderer& r) {
+    if (r.pendingInstances == 0) return;
+
+    size_t bytes = r.pendingInstances * sizeof(InstanceData);
+    StreamAllocation a = StreamAlloc(r.instanceStream, bytes, r.storageAlignment);
+    if (!a.ptr) {
+        std::cerr << "InstanceFlush: stream allocation failed, dropping " << r.pendingInstances
+                  << " instances\n";
+        StreamCommit(r.instanceStream, a);
+        for (InstanceMesh& mesh : r.meshes) mesh.instances.clear();
+        r.pendingInstances = 0;
+        return;
+    }
+
+    r.commands.clear();
+    uint8_t* dst = (uint8_t*)a.ptr;
+    GLuint baseInstance = 0;
+    for (InstanceMesh& mesh : r.meshes) {
+        if (mesh.instances.empty()) continue;
+        GLuint count = (GLuint)mesh.instances.size();
+        std::memcpy(dst + baseInstance * sizeof(InstanceData), mesh.instances.data(),
+                    count * sizeof(InstanceData));
+        const GeometryRange& g = GetGeometry(r.geometry, mesh.geometry);
+        r.commands.push_back({(GLuint)g.indexCount, count, g.firstIndex, g.baseVertex, baseInstance});
+        baseInstance += count;
+        mesh.instances.clear();
+    }
+    StreamCommit(r.instanceStream, a);
+    r.pendingInstances = 0;
+
+    StateUseProgram(r.indirectProgram);
+    BindGeometryPool(r.geometry, r.format);
+    BindVertexBuffer(1, r.instanceIndexBuffer);
+    StateBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, GLName(r.instanceStream.buffer), a.offset, a.size);
+    StateBindBuffer(GL_DRAW_INDIRECT_BUFFER, GLName(r.commandStream.buffer));
+    for (size_t first = 0; first < r.commands.size(); first += kInstanceMaxIndirectDraws) {
+        size_t count = std::min(r.commands.size() - first, kInstanceMaxIndirectDraws);
+        size_t commandBytes = count * sizeof(DrawElementsIndirectCommand);
+        StreamAllocation c = StreamAlloc(r.commandStream, commandBytes);
+        if (!c.ptr) {
+            std::cerr << "InstanceFlush: command allocation failed, dropping " << count << " draws\n";
+            StreamCommit(r.commandStream, c);
+            continue;
+        }
+        std::memcpy(c.ptr, r.commands.data() + first, commandBytes);
+        StreamCommit(r.commandStream, c);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)c.offset, (GLsizei)count, 0);
+        r.stats.drawCalls++;
+    }
+    r.stats.meshDraws += (uint32_t)r.commands.size();
+    r.stats.instances += baseInstance;
+}
+
+static void InitIndirect(InstanceRenderer& r, const ShaderProgram& program) {
+    r.indirect = true;
+    r.indirectShader = &program;
+    r.indirectProgram = program.id;
+    r.uIndirectViewProj = GetUniform<glm::mat4>(program, "uViewProj");
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment > 0) r.storageAlignment = (size_t)alignment;
+
+    InitStreamBuffer(r.commandStream, kInstanceMaxIndirectDraws * sizeof(DrawElementsIndirectCommand));
+    r.commands.reserve(kInstanceMaxIndirectDraws);
+
+    std::vector<GLuint> ids(r.maxInstances);
+    std::iota(ids.begin(), ids.end(), 0u);
+    r.instanceIndexBuffer = CreateGLResource<GLResourceType::Buffer>("Instance indices");
+    StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(r.instanceIndexBuffer));
+    glBufferData(GL_COPY_WRITE_BUFFER, ids.size() * sizeof(GLuint), ids.data(), GL_STATIC_DRAW);
+    SetGLResourceBytes(r.instanceIndexBuffer, ids.size() * sizeof(GLuint));
+}
+
+void InitInstanceRenderer(InstanceRenderer& r, const ShaderProgram& program, size_t maxInstances,
+                          const ShaderProgram* indirectProgram) {
+    r.shader = &program;
+    r.program = program.id;
+    r.uViewProj = GetUniform<glm::mat4>(program, "uViewProj");
+    r.maxInstances = maxInstances;
+    if (indirectProgram && GLAD_GL_VERSION_4_3) InitIndirect(r, *indirectProgram);
+    r.format = InstanceVertexFormat(r.indirect);
+    InitGeometryPool(r.geometry, "Instance", sizeof(BatchVertex));
+
+    // One full draw per segment, so a flush always fits, plus room to align an SSBO range
+    size_t segmentSize = r.maxInstances * sizeof(InstanceData);
+    if (r.indirect) segmentSize += r.storageAlignment;
+    InitStreamBuffer(r.instanceStream, segmentSize);
+}
+
+void CleanupInstanceRenderer(InstanceRenderer& r) {
+    if (r.indirect) {
+        DestroyGLResource(r.instanceIndexBuffer);
+        CleanupStreamBuffer(r.commandStream);
+        r.indirect = false;
+    }
+    CleanupGeometryPool(r.geometry);
+    r.meshes.clear();
+    r.freeMeshes.clear();
+    CleanupStreamBuffer(r.instanceStream);
+}
+
+size_t AddInstanceMesh(InstanceRenderer& r, const BatchVertex* vertices, size_t vertexCount,
+                       const uint32_t* indices, size_t indexCount) {
+    InstanceMesh* mesh;
+    size_t index;
+    if (!r.freeMeshes.empty()) {
+        index = r.freeMeshes.back();
+        r.freeMeshes.pop_back();
+        mesh = &r.meshes[index];
+    } else {
+        index = r.meshes.size();
+        mesh = &r.meshes.emplace_back();
+    }
+    mesh->geometry = AddGeometry(r.geometry, vertices, (uint32_t)vertexCount, indices, (uint32_t)indexCount);
+    return index;
+}
+
+void RemoveInstanceMesh(InstanceRenderer& r, size_t mesh) {
+    InstanceMesh& m = r.meshes[mesh];
+    if (!m.geometry) return;
+    if (r.indirect) r.pendingInstances -= m.instances.size();
+    m.instances.clear();
+    FreeGeometry(r.geometry, m.geometry);
+    r.freeMeshes.push_back(mesh);
+}
+
+size_t AddInstanceRectMesh(InstanceRenderer& r) {
+    const uint32_t white = glm::packUnorm4x8(glm::vec4(1.0f));
+    const BatchVertex vertices[] = {
+        {{-0.5f, -0.5f}, white},
+        {{0.5f, -0.5f}, white},
+        {{0.5f, 0.5f}, white},
+        {{-0.5f, 0.5f}, white},
+    };
+    const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+    return AddInstanceMesh(r, vertices, 4, indices, 6);
+}
+
+size_t AddInstanceCircleMesh(InstanceRenderer& r, int segments) {
+    if (segments < 3) segments = 3;
+    const uint32_t white = glm::packUnorm4x8(glm::vec4(1.0f));
+    std::vector<BatchVertex> vertices;
+    std::vector<uint32_t> indices;
+    vertices.push_back({glm::vec2(0.0f), white});
+    const float step = 6.28318530718f / segments;
+    for (int i = 0; i < segments; i++) {
+        vertices.push_back({glm::vec2(std::cos(i * step), std::sin(i * step)), white});
+        uint32_t next = (i + 1) % segments;
+        indices.insert(indices.end(), {0u, 1u + i, 1u + next});
+    }
+    return AddInstanceMesh(r, vertices.data(), vertices.size(), indices.data(), indices.size());
+}
+
+void InstanceBegin(InstanceRenderer& r, const glm::mat4& viewProj) {
+    r.viewProj = viewProj;
+    r.stats = InstanceStats{};
+    for (InstanceMesh& mesh : r.meshes) mesh.instances.clear();
+
+    if (r.shader->id != r.program) {
+        // Program was swapped by a reload, locations may have moved
+        r.program = r.shader->id;
+        r.uViewProj = GetUniform<glm::mat4>(*r.shader, "uViewProj");
+    }
+    StateUseProgram(r.program);
+    SetUniform(r.uViewProj, r.viewProj);
+
+    if (r.indirect) {
+        if (r.indirectShader->id != r.indirectProgram) {
+            r.indirectProgram = r.indirectShader->id;
+            r.uIndirectViewProj = GetUniform<glm::mat4>(*r.indirectShader, "uViewProj");
+        }
+        StateUseProgram(r.indirectProgram);
+        SetUniform(r.uIndirectViewProj, r.viewProj);
+    }
+}
+
+void InstancePush(InstanceRenderer& r, size_t mesh, const InstanceData& instance) {
+    InstanceMesh& m = r.meshes[mesh];
+    if (r.indirect) {
+        if (r.pendingInstances >= r.maxInstances) FlushIndirect(r);
+        r.pendingInstances++;
+    } else if (m.instances.size() >= r.maxInstances) {
+        FlushMesh(r, m);
+    }
+    m.instances.push_back(instance);
+}
+
+void InstanceFlush(InstanceRenderer& r) {
+    ZoneScoped;
+    if (r.indirect) {
+        FlushIndirect(r);
+        return;
+    }
+    for (InstanceMesh& mesh : r.meshes) FlushMesh(r, mesh);
+}
+
+void InstanceEnd(InstanceRenderer& r) {
+    InstanceFlush(r);
+    StreamEndFrame(r.instanceStream);
+    if (r.indirect) StreamEndFrame(r.commandStream);
+}
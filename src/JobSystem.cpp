@@ -0,0 +1,368 @@
+// src/JobSystem.cpp
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <tracy/Tracy.hpp>
+
+static const int kJobSpinsBeforeSleep = 64;
+
+// Terminates continuation lists, so an empty list on a busy counter isn't null
+static Job sOpenCounter;
+// Index into JobSystem::threads, -1 for threads the scheduler doesn't know
+static thread_local int tThreadIndex = -1;
+
+struct WorkerStart {
+    JobSystem* js;
+    int index;
+};
+
+// Deque indices wrap; only their differences are meaningful.
+static int IndexDistance(int from, int to) {
+    return (int)((unsigned)to - (unsigned)from);
+}
+
+static bool DequePush(JobDeque& d, Job* job) {
+    int b = SDL_GetAtomicInt(&d.bottom);
+    int t = SDL_GetAtomicInt(&d.top);
+    if (IndexDistance(t, b) >= kJobDequeSize) return false;
+    SDL_SetAtomicPointer(&d.jobs[b & (kJobDequeSize - 1)], job);
+    SDL_AddAtomicInt(&d.bottom, 1); // Full barrier: the job is visible before the new bottom
+    return true;
+}
+
+static Job* DequePop(JobDeque& d) {
+    // Claim the bottom job first, then look at top; the add is a full barrier,
+    // so a thief either sees the claim or we see its steal
+    int b = SDL_AddAtomicInt(&d.bottom, -1) - 1;
+    int t = SDL_GetAtomicInt(&d.top);
+    int size = IndexDistance(t, b) + 1;
+    if (size <= 0) {
+        SDL_SetAtomicInt(&d.bottom, t); // Was empty
+        return nullptr;
+    }
+    Job* job = (Job*)SDL_GetAtomicPointer(&d.jobs[b & (kJobDequeSize - 1)]);
+    if (size > 1) return job;
+
+    // Last one: thieves may be after it too
+    bool won = SDL_CompareAndSwapAtomicInt(&d.top, t, t + 1);
+    SDL_SetAtomicInt(&d.bottom, t + 1);
+    return won ? job : nullptr;
+}
+
+static Job* DequeSteal(JobDeque& d) {
+    int t = SDL_GetAtomicInt(&d.top);
+    int b = SDL_GetAtomicInt(&d.bottom);
+    if (IndexDistance(t, b) <= 0) return nullptr;
+    Job* job = (Job*)SDL_GetAtomicPointer(&d.jobs[t & (kJobDequeSize - 1)]);
+    if (!SDL_CompareAndSwapAtomicInt(&d.top, t, t + 1)) return nullptr; // Lost to the owner or another thief
+    return job;
+}
+
+static Job* AllocJob(JobThread& thread, const Job& desc) {
+    Job* job = &thread.pool[thread.poolNext++ & (kJobPoolSize - 1)];
+    *job = desc;
+    job->next = nullptr;
+    return job;
+}
+
+static void WakeWorkers(JobSystem& js, int jobs) {
+    int sleeping = SDL_GetAtomicInt(&js.sleeping);
+    for (int i = 0; i < std::min(sleeping, jobs); i++) SDL_SignalSemaphore(js.wake);
+}
+
+static void Execute(JobSystem& js, Job* job);
+
+// Queues a job on the calling thread, or runs it if the deque is full.
+static void PushJob(JobSystem& js, Job* job) {
+    if (!DequePush(js.threads[tThreadIndex].deque, job)) {
+        Execute(js, job);
+        return;
+    }
+    WakeWorkers(js, 1);
+}
+
+// Counts a job of counter as done and queues the counter's continuations
+// if it was the last one.
+static void FinishJob(JobSystem& js, JobCounter* counter) {
+    if (!counter || SDL_AddAtomicInt(&counter->pending, -1) != 1) return;
+    // Compare and swap rather than SDL_SetAtomicPointer, which is only an
+    // acquire barrier: whoever sees null next may free the counter
+    void* head;
+    do {
+        head = SDL_GetAtomicPointer(&counter->continuations);
+    } while (!SDL_CompareAndSwapAtomicPointer(&counter->continuations, head, nullptr));
+    Job* job = (Job*)head;
+    while (job && job != &sOpenCounter) {
+        Job* next = job->next;
+        if (tThreadIndex >= 0) {
+            PushJob(js, job);
+        } else {
+            Execute(js, job);
+        }
+        job = next;
+    }
+}
+
+static void Execute(JobSystem& js, Job* job) {
+    JobCounter* counter = job->counter; // The slot may be reused once the counter drops
+    job->fn(job->data, job->begin, job->end);
+    if (tThreadIndex >= 0) js.threads[tThreadIndex].stats.executed++;
+    FinishJob(js, counter);
+}
+
+// Own deque first, then a steal from the others starting at a random one.
+static Job* FindJob(JobSystem& js, int self) {
+    JobThread& thread = js.threads[self];
+    if (Job* job = DequePop(thread.deque)) return job;
+
+    // xorshift32
+    uint32_t x = thread.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    thread.random = x;
+    for (int i = 0; i < js.threadCount; i++) {
+        int victim = (int)((x + i) % js.threadCount);
+        if (victim == self) continue;
+        if (Job* job = DequeSteal(js.threads[victim].deque)) {
+            thread.stats.stolen++;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+static void PinThread(int core) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "JobSystem: pinning to core " << core << " failed\n";
+    }
+#elif defined(_WIN32)
+    if (!SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core)) {
+        std::cerr << "JobSystem: pinning to core " << core << " failed\n";
+    }
+#else
+    (void)core;
+#endif
+}
+
+static int WorkerMain(void* data) {
+    WorkerStart start = *(WorkerStart*)data;
+    delete (WorkerStart*)data;
+    JobSystem& js = *start.js;
+    tThreadIndex = start.index;
+    if (js.pinned) PinThread(start.index); // Core 0 is left to the initializing thread
+    JobThread& thread = js.threads[start.index];
+
+    int idle = 0;
+    while (!SDL_GetAtomicInt(&js.quit)) {
+        if (Job* job = FindJob(js, start.index)) {
+            Execute(js, job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < kJobSpinsBeforeSleep) {
+            SDL_CPUPauseInstruction();
+            continue;
+        }
+
+        // Announce the sleep before looking one last time, so a push either
+        // sees us sleeping and signals, or we see its job
+        SDL_AddAtomicInt(&js.sleeping, 1);
+        Job* job = FindJob(js, start.index);
+        if (!job && !SDL_GetAtomicInt(&js.quit)) {
+            ZoneScopedN("Job worker sleep");
+            thread.stats.sleeps++;
+            SDL_WaitSemaphore(js.wake);
+        }
+        SDL_AddAtomicInt(&js.sleeping, -1);
+        if (job) Execute(js, job);
+        idle = 0;
+    }
+    return 0;
+}
+
+void InitJobSystem(JobSystem& js, int workers, bool pin) {
+    int cores = SDL_GetNumLogicalCPUCores();
+    if (workers < 0) workers = cores - 1;
+    js.workerCount = std::max(0, std::min(workers, kJobMaxWorkers));
+    js.threadCount = js.workerCount + 1 + kJobExternalThreads;
+    js.pinned = pin && js.workerCount < cores;
+    js.threads = new JobThread[js.threadCount];
+    for (int i = 0; i < js.threadCount; i++) js.threads[i].random = 0x9E3779B9u * (i + 1);
+    js.wake = SDL_CreateSemaphore(0);
+    SDL_SetAtomicInt(&js.quit, 0);
+    SDL_SetAtomicInt(&js.attached, 0);
+
+    tThreadIndex = 0;
+    if (js.pinned) PinThread(0);
+    for (int i = 0; i < js.workerCount; i++) {
+        char name[16];
+        SDL_snprintf(name, sizeof(name), "Job %d", i + 1);
+        WorkerStart* start = new WorkerStart{&js, i + 1};
+        js.workers[i] = SDL_CreateThread(WorkerMain, name, start);
+        if (!js.workers[i]) {
+            std::cerr << "JobSystem: SDL_CreateThread failed: " << SDL_GetError() << "\n";
+            delete start;
+        }
+    }
+    std::cout << "Job system: " << js.workerCount << " workers on " << cores << " logical cores"
+              << (js.pinned ? ", pinned" : "") << "\n";
+}
+
+void CleanupJobSystem(JobSystem& js) {
+    SDL_SetAtomicInt(&js.quit, 1);
+    for (int i = 0; i < js.workerCount; i++) SDL_SignalSemaphore(js.wake);
+    for (int i = 0; i < js.workerCount; i++) {
+        if (js.workers[i]) SDL_WaitThread(js.workers[i], nullptr);
+        js.workers[i] = nullptr;
+    }
+    SDL_DestroySemaphore(js.wake);
+    js.wake = nullptr;
+
+    // Workers are joined, their stats can be read
+    js.totals = JobThreadStats{};
+    for (int i = 0; i < js.threadCount; i++) {
+        js.totals.executed += js.threads[i].stats.executed;
+        js.totals.stolen += js.threads[i].stats.stolen;
+        js.totals.sleeps += js.threads[i].stats.sleeps;
+    }
+    delete[] js.threads;
+    js.threads = nullptr;
+    js.workerCount = 0;
+    js.threadCount = 0;
+    tThreadIndex = -1;
+}
+
+bool AttachJobThread(JobSystem& js) {
+    if (tThreadIndex >= 0) return true;
+    int slot = SDL_AddAtomicInt(&js.attached, 1);
+    if (slot >= kJobExternalThreads) {
+        std::cerr << "JobSystem: no slot left for another thread, its jobs will run inline\n";
+        return false;
+    }
+    tThreadIndex = js.workerCount + 1 + slot;
+    return true;
+}
+
+void InitJobCounter(JobCounter& counter) {
+    SDL_SetAtomicInt(&counter.pending, 0);
+    SDL_SetAtomicPointer(&counter.continuations, nullptr);
+}
+
+bool JobCounterDone(JobCounter& counter) {
+    // The list goes null after the last job's decrement, once the finishing
+    // thread is through with the counter, so the caller may then free it
+    return SDL_GetAtomicInt(&counter.pending) == 0 && !SDL_GetAtomicPointer(&counter.continuations);
+}
+
+// Reopens a counter that's at zero, so continuations wait for the new jobs.
+static void AddPending(JobCounter& counter, int count) {
+    SDL_CompareAndSwapAtomicPointer(&counter.continuations, nullptr, &sOpenCounter);
+    SDL_AddAtomicInt(&counter.pending, count);
+}
+
+void RunJobs(JobSystem& js, const Job* jobs, size_t count, JobCounter* counter) {
+    if (count == 0) return;
+    if (counter) AddPending(*counter, (int)count);
+    if (tThreadIndex < 0) {
+        // Unknown thread: no deque to push to
+        for (size_t i = 0; i < count; i++) {
+            Job job = jobs[i];
+            job.counter = counter;
+            Execute(js, &job);
+        }
+        return;
+    }
+
+    JobThread& thread = js.threads[tThreadIndex];
+    for (size_t i = 0; i < count; i++) {
+        Job* job = AllocJob(thread, jobs[i]);
+        job->counter = counter;
+        if (!DequePush(thread.deque, job)) Execute(js, job); // Full, do it now
+    }
+    WakeWorkers(js, (int)count);
+}
+
+void RunJobsAfter(JobSystem& js, JobCounter& dependency, const Job* jobs, size_t count, JobCounter* counter) {
+    if (count == 0) return;
+    if (tThreadIndex < 0) {
+        while (!JobCounterDone(dependency)) SDL_CPUPauseInstruction();
+        RunJobs(js, jobs, count, counter);
+        return;
+    }
+
+    if (counter) AddPending(*counter, (int)count);
+    JobThread& thread = js.threads[tThreadIndex];
+    for (size_t i = 0; i < count; i++) {
+        Job* job = AllocJob(thread, jobs[i]);
+        job->counter = counter;
+        while (true) {
+            void* head = SDL_GetAtomicPointer(&dependency.continuations);
+            if (!head) {
+                PushJob(js, job); // Dependency already done
+                break;
+            }
+            job->next = (Job*)head;
+            if (SDL_CompareAndSwapAtomicPointer(&dependency.continuations, head, job)) break;
+        }
+    }
+}
+
+void WaitForCounter(JobSystem& js, JobCounter& counter) {
+    if (JobCounterDone(counter)) return;
+    ZoneScopedN("Job wait");
+    while (!JobCounterDone(counter)) {
+        Job* job = tThreadIndex >= 0 ? FindJob(js, tThreadIndex) : nullptr;
+        if (job) {
+            Execute(js, job);
+        } else {
+            SDL_CPUPauseInstruction();
+        }
+    }
+}
+
+void ParallelFor(JobSystem& js, uint32_t count, uint32_t minBatch, JobFn fn, void* data) {
+    if (count == 0) return;
+    // A few batches per thread, so a slow one can be balanced by stealing
+    uint32_t threads = (uint32_t)js.workerCount + 1;
+    uint32_t batch = std::max(std::max(minBatch, 1u), (count + threads * 4 - 1) / (threads * 4));
+    uint32_t batches = (count + batch - 1) / batch;
+    if (batches == 1 || js.workerCount == 0 || tThreadIndex < 0) {
+        fn(data, 0, count);
+        return;
+    }
+
+    Job jobs[256];
+    batches = std::min<uint32_t>(batches, 256);
+    batch = (count + batches - 1) / batches;
+    JobCounter counter;
+    uint32_t n = 0;
+    for (uint32_t begin = 0; begin < count; begin += batch) {
+        jobs[n].fn = fn;
+        jobs[n].data = data;
+        jobs[n].begin = begin;
+        jobs[n].end = std::min(count, begin + batch);
+        n++;
+    }
+    RunJobs(js, jobs, n, &counter);
+    WaitForCounter(js, counter);
+}
+
+void PrintJobSystemStats(const JobSystem& js) {
+    std::cout << "Jobs: " << js.totals.executed << " executed, " << js.totals.stolen << " stolen, "
+              << js.totals.sleeps << " worker sleeps\n";
+}
@@ -0,0 +1,110 @@
+// src/Platform.cpp
+
+#include "Platform.h"
+#include "AllocTracker.h"
+
+#include <glad/glad.h>
+#include "SDL3/SDL_error.h"
+#include "SDL3/SDL_log.h"
+#include "SDL3/SDL_video.h"
+#include "imgui_impl_opengl3.h"
+#include "imgui_impl_sdl3.h"
+
+#include <cstdlib>
+#include <iostream>
+
+void SetGLAttributes() {
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+}
+void InitSDL(bool headless){
+    if (headless) {
+        // No display needed: SDL's offscreen driver gets its GL context through EGL
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    }
+    if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return;
+    }
+}
+GLContext InitSDLGL(const char* title, int width, int height, bool headless) {
+    GLContext gl;
+
+    gl.window = SDL_CreateWindow(
+        title, width, height,
+        headless ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN : SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE
+    );
+
+    if (!gl.window) {
+	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateWindow failed: %s", SDL_GetError());
+        SDL_Quit();
+        std::exit(-1);
+    }
+
+    gl.context = SDL_GL_CreateContext(gl.window);
+    if (!gl.context) {
+	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_GL_CreateContext failed: %s", SDL_GetError());
+        SDL_DestroyWindow(gl.window);
+        SDL_Quit();
+        std::exit(-1);
+    }
+
+    SDL_GL_MakeCurrent(gl.window, gl.context);
+    SDL_GL_SetSwapInterval(headless ? 0 : 1); // Headless runs uncapped
+
+    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to init GlAD: %s", SDL_GetError());
+        SDL_GL_DestroyContext(gl.context);
+        SDL_DestroyWindow(gl.window);
+        SDL_Quit();
+        std::exit(-1);
+    }
+
+    return gl;
+}
+void PrintGLInfo(){
+
+    std::cout << "OpenGL Vendor: " << glGetString(GL_VENDOR) << "\n";
+    std::cout << "OpenGL Renderer: " << glGetString(GL_RENDERER) << "\n";
+    std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
+    std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION)
+              << "\n";
+}
+ImGuiIO& InitIMGUI(GLContext gl){
+    IMGUI_CHECKVERSION();
+    // Counted with the rest of the program's heap use
+    ImGui::SetAllocatorFunctions(TrackedAlloc, TrackedFree);
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    (void)io;
+
+    ImGui::StyleColorsDark();
+
+    const char* glsl_version = "#version 330 core"; // Match shader version
+    ImGui_ImplSDL3_InitForOpenGL(gl.window, gl.context);
+    ImGui_ImplOpenGL3_Init(glsl_version);
+    // Now, while this thread has the context. NewFrame would create them
+    // lazily, and may run on a thread without one.
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+
+    return io;
+}
+void CleanupImgui(){
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplSDL3_Shutdown();
+    ImGui::DestroyContext();
+    return;
+}
+
+void CleanupSDL(GLContext gl){
+
+    SDL_GL_DestroyContext(gl.context);
+    SDL_DestroyWindow(gl.window);
+    SDL_Quit();
+
+    return;
+}
@@ -0,0 +1,132 @@
+// src/ProgramCache.cpp
+
+#include "ProgramCache.h"
+#include "Hash.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+static const uint32_t kCacheMagic = 0x4e494250; // "PBIN"
+static const uint32_t kCacheVersion = 1;
+
+struct CacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+    double compileMs; // How long the source path took when the entry was written
+};
+
+static double MsSince(std::chrono::high_resolution_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - t).count();
+}
+
+static std::string CachePath(const ProgramCache& cache, uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 ".bin", key);
+    return cache.directory + "/" + name;
+}
+
+void InitProgramCache(ProgramCache& cache, const char* directory) {
+    cache.directory = directory;
+    cache.stats = ProgramCacheStats{};
+    cache.driver = std::string((const char*)glGetString(GL_RENDERER)) + "|" +
+                   (const char*)glGetString(GL_VERSION);
+
+    GLint formats = 0;
+    if (GLAD_GL_VERSION_4_1) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    cache.enabled = formats > 0;
+    if (!cache.enabled) {
+        std::cout << "Program cache: disabled, driver has no program binary formats\n";
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache.directory, ec);
+    if (ec) {
+        std::cerr << "Program cache: can't create " << cache.directory << ": " << ec.message() << "\n";
+        cache.enabled = false;
+    }
+}
+
+uint64_t ProgramCacheKey(const ProgramCache& cache, const std::string& vertexSource,
+                         const std::string& fragmentSource, const std::string& defines) {
+    uint64_t key = HashString(vertexSource);
+    key = HashString(fragmentSource, key);
+    key = HashString(defines, key);
+    return HashString(cache.driver, key);
+}
+
+GLuint ProgramCacheLoad(ProgramCache& cache, uint64_t key) {
+    if (!cache.enabled) return 0;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file(CachePath(cache, key), std::ios::binary);
+    if (!file) return 0;
+
+    CacheFileHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || header.magic != kCacheMagic ||
+        header.version != kCacheVersion || header.key != key) {
+        return 0;
+    }
+    std::vector<char> binary(header.binaryLength);
+    if (!file.read(binary.data(), binary.size())) return 0;
+
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        glDeleteProgram(p);
+        cache.stats.rejected++;
+        return 0;
+    }
+
+    double ms = MsSince(start);
+    cache.stats.hits++;
+    cache.stats.loadMs += ms;
+    cache.stats.savedMs += header.compileMs - ms;
+    return p;
+}
+
+void ProgramCacheStore(ProgramCache& cache, uint64_t key, GLuint program, double compileMs) {
+    cache.stats.misses++;
+    cache.stats.compileMs += compileMs;
+    if (!cache.enabled) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    CacheFileHeader header = {kCacheMagic, kCacheVersion, key, format, (uint32_t)length, compileMs};
+    std::ofstream file(CachePath(cache, key), std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Program cache: failed to write " << CachePath(cache, key) << "\n";
+        return;
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write(binary.data(), binary.size());
+}
+
+void PrintProgramCacheStats(const ProgramCache& cache) {
+    const ProgramCacheStats& s = cache.stats;
+    std::cout << std::fixed << std::setprecision(2)
+              << "Program cache: " << s.hits << " hits, " << s.misses << " misses, "
+              << s.rejected << " rejected; load " << s.loadMs << " ms, compile "
+              << s.compileMs << " ms, saved " << s.savedMs << " ms\n"
+              << std::defaultfloat;
+}
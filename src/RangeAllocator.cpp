@@ -0,0 +1,222 @@
+// src/RangeAllocator.cpp
+
+#include "RangeAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const uint32_t kMantissaBits = 3;
+static const uint32_t kMantissaValue = 1u << kMantissaBits;
+static const uint32_t kMantissaMask = kMantissaValue - 1;
+
+static uint32_t LowestBit(uint32_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return index;
+#else
+    return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+static uint32_t HighestBit(uint32_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return index;
+#else
+    return 31 - (uint32_t)__builtin_clz(v);
+#endif
+}
+
+// The small float is exponent << 3 | mantissa.
+uint32_t RangeSizeBin(uint32_t size, bool roundUp) {
+    if (size < kMantissaValue) return size;
+    uint32_t shift = HighestBit(size) - kMantissaBits;
+    uint32_t bin = ((shift + 1) << kMantissaBits) | ((size >> shift) & kMantissaMask);
+    if (roundUp && (size & ((1u << shift) - 1))) bin++; // A mantissa carry moves on to the next exponent
+    return bin;
+}
+
+// First non-empty class at or above bin, kRangeNone if there is none.
+static uint32_t FindFreeBin(const RangeAllocator& a, uint32_t bin) {
+    if (bin >= (uint32_t)kRangeBins) return kRangeNone;
+    uint32_t group = bin >> 3;
+    uint32_t inGroup = a.binMasks[group] & (0xFFu << (bin & 7));
+    if (inGroup) return (group << 3) | LowestBit(inGroup);
+    uint32_t groups = group + 1 < (uint32_t)kRangeBinGroups ? a.topMask & (~0u << (group + 1)) : 0;
+    if (!groups) return kRangeNone;
+    group = LowestBit(groups);
+    return (group << 3) | LowestBit(a.binMasks[group]);
+}
+
+static void InsertFree(RangeAllocator& a, uint32_t index) {
+    RangeNode& node = a.nodes[index];
+    uint32_t bin = RangeSizeBin(node.size, false);
+    node.used = false;
+    node.prevFree = kRangeNone;
+    node.nextFree = a.binHeads[bin];
+    if (node.nextFree != kRangeNone) a.nodes[node.nextFree].prevFree = index;
+    a.binHeads[bin] = index;
+    a.binMasks[bin >> 3] |= (uint8_t)(1u << (bin & 7));
+    a.topMask |= 1u << (bin >> 3);
+}
+
+// Before the node's size changes: the class is found from it.
+static void RemoveFree(RangeAllocator& a, uint32_t index) {
+    RangeNode& node = a.nodes[index];
+    if (node.prevFree != kRangeNone) {
+        a.nodes[node.prevFree].nextFree = node.nextFree;
+    } else {
+        uint32_t bin = RangeSizeBin(node.size, false);
+        a.binHeads[bin] = node.nextFree;
+        if (node.nextFree == kRangeNone) {
+            a.binMasks[bin >> 3] &= (uint8_t)~(1u << (bin & 7));
+            if (!a.binMasks[bin >> 3]) a.topMask &= ~(1u << (bin >> 3));
+        }
+    }
+    if (node.nextFree != kRangeNone) a.nodes[node.nextFree].prevFree = node.prevFree;
+    node.prevFree = kRangeNone;
+    node.nextFree = kRangeNone;
+}
+
+// May reallocate nodes, so don't hold references across it.
+static uint32_t NewNode(RangeAllocator& a) {
+    if (!a.unusedNodes.empty()) {
+        uint32_t index = a.unusedNodes.back();
+        a.unusedNodes.pop_back();
+        a.nodes[index] = RangeNode{};
+        return index;
+    }
+    a.nodes.push_back(RangeNode{});
+    return (uint32_t)a.nodes.size() - 1;
+}
+
+// Unlinks next from the physical list after adding its size to index. next
+// is left unused, so a second RangeFree of it is refused.
+static void Absorb(RangeAllocator& a, uint32_t index, uint32_t next) {
+    RangeNode& node = a.nodes[index];
+    node.size += a.nodes[next].size;
+    a.nodes[next].used = false;
+    node.nextPhysical = a.nodes[next].nextPhysical;
+    if (node.nextPhysical != kRangeNone) {
+        a.nodes[node.nextPhysical].prevPhysical = index;
+    } else {
+        a.tail = index;
+    }
+    a.unusedNodes.push_back(next);
+}
+
+// Merges a no longer used node with free neighbours and files it.
+static void Release(RangeAllocator& a, uint32_t index) {
+    uint32_t prev = a.nodes[index].prevPhysical;
+    if (prev != kRangeNone && !a.nodes[prev].used) {
+        RemoveFree(a, prev);
+        Absorb(a, prev, index);
+        index = prev;
+    }
+    uint32_t next = a.nodes[index].nextPhysical;
+    if (next != kRangeNone && !a.nodes[next].used) {
+        RemoveFree(a, next);
+        Absorb(a, index, next);
+    }
+    InsertFree(a, index);
+}
+
+void InitRangeAllocator(RangeAllocator& a, uint32_t capacity) {
+    a.capacity = 0;
+    a.freeUnits = 0;
+    a.allocations = 0;
+    a.tail = kRangeNone;
+    a.topMask = 0;
+    for (uint8_t& mask : a.binMasks) mask = 0;
+    for (uint32_t& head : a.binHeads) head = kRangeNone;
+    a.nodes.clear();
+    a.unusedNodes.clear();
+    GrowRangeAllocator(a, capacity);
+}
+
+RangeAllocation RangeAlloc(RangeAllocator& a, uint32_t size) {
+    RangeAllocation result;
+    if (size == 0) return result;
+    uint32_t index = kRangeNone;
+    uint32_t bin = FindFreeBin(a, RangeSizeBin(size, true));
+    if (bin != kRangeNone) {
+        index = a.binHeads[bin];
+    } else {
+        // Nothing is certain to fit, but ranges of the request's own class may
+        for (uint32_t i = a.binHeads[RangeSizeBin(size, false)]; i != kRangeNone; i = a.nodes[i].nextFree) {
+            if (a.nodes[i].size >= size) {
+                index = i;
+                break;
+            }
+        }
+        if (index == kRangeNone) return result;
+    }
+
+    RemoveFree(a, index);
+    uint32_t remainder = a.nodes[index].size - size;
+    if (remainder) {
+        // The rest stays free, right behind the allocation
+        uint32_t rest = NewNode(a);
+        RangeNode& node = a.nodes[index];
+        RangeNode& restNode = a.nodes[rest];
+        restNode.offset = node.offset + size;
+        restNode.size = remainder;
+        restNode.prevPhysical = index;
+        restNode.nextPhysical = node.nextPhysical;
+        if (node.nextPhysical != kRangeNone) {
+            a.nodes[node.nextPhysical].prevPhysical = rest;
+        } else {
+            a.tail = rest;
+        }
+        node.nextPhysical = rest;
+        node.size = size;
+        InsertFree(a, rest);
+    }
+    a.nodes[index].used = true;
+    a.freeUnits -= size;
+    a.allocations++;
+    result.offset = a.nodes[index].offset;
+    result.node = index;
+    return result;
+}
+
+void RangeFree(RangeAllocator& a, uint32_t node) {
+    if (node >= a.nodes.size() || !a.nodes[node].used) return;
+    a.freeUnits += a.nodes[node].size;
+    a.allocations--;
+    Release(a, node);
+}
+
+void GrowRangeAllocator(RangeAllocator& a, uint32_t capacity) {
+    if (capacity <= a.capacity) return;
+    // Appended as a used node and released, which merges it with a free tail
+    uint32_t index = NewNode(a);
+    RangeNode& node = a.nodes[index];
+    node.offset = a.capacity;
+    node.size = capacity - a.capacity;
+    node.used = true;
+    node.prevPhysical = a.tail;
+    if (a.tail != kRangeNone) a.nodes[a.tail].nextPhysical = index;
+    a.tail = index;
+    a.freeUnits += capacity - a.capacity;
+    a.capacity = capacity;
+    Release(a, index);
+}
+
+uint32_t LargestFreeRange(const RangeAllocator& a) {
+    if (!a.topMask) return 0;
+    uint32_t group = HighestBit(a.topMask);
+    uint32_t bin = (group << 3) | HighestBit(a.binMasks[group]);
+    uint32_t largest = 0;
+    for (uint32_t i = a.binHeads[bin]; i != kRangeNone; i = a.nodes[i].nextFree) {
+        if (a.nodes[i].size > largest) largest = a.nodes[i].size;
+    }
+    return largest;
+}
+
+bool RangePackPays(const RangeAllocator& a, uint32_t size) {
+    return a.freeUnits >= size && a.freeUnits - size >= a.capacity / 4;
+}
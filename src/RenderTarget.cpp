@@ -0,0 +1,48 @@
+// src/RenderTarget.cpp
+
+#include "RenderTarget.h"
+#include "GLState.h"
+
+#include <iostream>
+
+bool InitRenderTarget(RenderTarget& rt, int width, int height) {
+    rt.width = width;
+    rt.height = height;
+
+    rt.color = CreateGLResource<GLResourceType::Renderbuffer>("RenderTarget color");
+    glBindRenderbuffer(GL_RENDERBUFFER, GLName(rt.color));
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    SetGLResourceBytes(rt.color, (uint64_t)width * height * 4);
+    rt.depthStencil = CreateGLResource<GLResourceType::Renderbuffer>("RenderTarget depth/stencil");
+    glBindRenderbuffer(GL_RENDERBUFFER, GLName(rt.depthStencil));
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    SetGLResourceBytes(rt.depthStencil, (uint64_t)width * height * 4);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    rt.fbo = CreateGLResource<GLResourceType::Framebuffer>("RenderTarget");
+    StateBindFramebuffer(GL_FRAMEBUFFER, GLName(rt.fbo));
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, GLName(rt.color));
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              GLName(rt.depthStencil));
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    StateBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "RenderTarget: framebuffer incomplete (0x" << std::hex << status << std::dec << ")\n";
+        CleanupRenderTarget(rt);
+        return false;
+    }
+    return true;
+}
+
+void CleanupRenderTarget(RenderTarget& rt) {
+    DestroyGLResource(rt.fbo);
+    DestroyGLResource(rt.color);
+    DestroyGLResource(rt.depthStencil);
+    rt = RenderTarget{};
+}
+
+void BindRenderTarget(const RenderTarget& rt) {
+    StateBindFramebuffer(GL_FRAMEBUFFER, GLName(rt.fbo));
+    StateViewport(0, 0, rt.width, rt.height);
+}
@@ -0,0 +1,120 @@
+// src/RenderThread.cpp
+
+#include "RenderThread.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include <tracy/Tracy.hpp>
+
+static int RenderThreadMain(void* data) {
+    RenderThread& rt = *(RenderThread*)data;
+    if (!SDL_GL_MakeCurrent(rt.gl.window, rt.gl.context)) {
+        std::cerr << "RenderThread: SDL_GL_MakeCurrent failed: " << SDL_GetError() << "\n";
+        std::exit(-1);
+    }
+
+    SDL_LockMutex(rt.mutex);
+    while (true) {
+        int slot = rt.readSlot;
+        if (!rt.submitted[slot]) {
+            if (rt.quit) break;
+            rt.stats.renderWaits++;
+            ZoneScopedN("Wait for packet");
+            while (!rt.submitted[slot] && !rt.quit) SDL_WaitCondition(rt.changed, rt.mutex);
+            continue;
+        }
+        SDL_UnlockMutex(rt.mutex);
+
+        rt.render(rt.user, rt.packets[slot]);
+
+        SDL_LockMutex(rt.mutex);
+        rt.submitted[slot] = false;
+        rt.readSlot = (slot + 1) % kRenderPackets;
+        rt.stats.frames++;
+        SDL_BroadcastCondition(rt.changed);
+    }
+    SDL_UnlockMutex(rt.mutex);
+
+    SDL_GL_MakeCurrent(rt.gl.window, nullptr);
+    return 0;
+}
+
+void StartRenderThread(RenderThread& rt, GLContext gl, RenderPacketFn render, void* user,
+                       void* packetA, void* packetB, bool threaded) {
+    rt.gl = gl;
+    rt.render = render;
+    rt.user = user;
+    rt.packets[0] = packetA;
+    rt.packets[1] = packetB;
+    if (!threaded) return;
+
+    rt.mutex = SDL_CreateMutex();
+    rt.changed = SDL_CreateCondition();
+    // A context can only be current on one thread
+    SDL_GL_MakeCurrent(gl.window, nullptr);
+    rt.thread = SDL_CreateThread(RenderThreadMain, "Render", &rt);
+    if (!rt.thread) {
+        std::cerr << "RenderThread: SDL_CreateThread failed (" << SDL_GetError() << "), rendering inline\n";
+        SDL_GL_MakeCurrent(gl.window, gl.context);
+        SDL_DestroyCondition(rt.changed);
+        SDL_DestroyMutex(rt.mutex);
+        rt.changed = nullptr;
+        rt.mutex = nullptr;
+    }
+}
+
+void StopRenderThread(RenderThread& rt) {
+    if (!rt.thread) return;
+    SDL_LockMutex(rt.mutex);
+    rt.quit = true;
+    SDL_BroadcastCondition(rt.changed);
+    SDL_UnlockMutex(rt.mutex);
+    SDL_WaitThread(rt.thread, nullptr);
+    rt.thread = nullptr;
+
+    SDL_DestroyCondition(rt.changed);
+    SDL_DestroyMutex(rt.mutex);
+    rt.changed = nullptr;
+    rt.mutex = nullptr;
+    SDL_GL_MakeCurrent(rt.gl.window, rt.gl.context);
+}
+
+void* AcquirePacket(RenderThread& rt) {
+    int slot = rt.writeSlot;
+    if (!rt.thread) return rt.packets[slot];
+
+    SDL_LockMutex(rt.mutex);
+    if (rt.submitted[slot]) {
+        ZoneScopedN("Wait for render thread");
+        uint64_t start = SDL_GetPerformanceCounter();
+        rt.stats.mainWaits++;
+        while (rt.submitted[slot]) SDL_WaitCondition(rt.changed, rt.mutex);
+        rt.stats.mainWaitMs += (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+    SDL_UnlockMutex(rt.mutex);
+    return rt.packets[slot];
+}
+
+void SubmitPacket(RenderThread& rt) {
+    int slot = rt.writeSlot;
+    rt.writeSlot = (slot + 1) % kRenderPackets;
+    if (!rt.thread) {
+        rt.render(rt.user, rt.packets[slot]);
+        rt.stats.frames++;
+        return;
+    }
+
+    SDL_LockMutex(rt.mutex);
+    rt.submitted[slot] = true;
+    SDL_BroadcastCondition(rt.changed);
+    SDL_UnlockMutex(rt.mutex);
+}
+
+RenderThreadStats GetRenderThreadStats(RenderThread& rt) {
+    if (!rt.thread) return rt.stats;
+    SDL_LockMutex(rt.mutex);
+    RenderThreadStats stats = rt.stats;
+    SDL_UnlockMutex(rt.mutex);
+    return stats;
+}
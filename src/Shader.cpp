@@ -0,0 +1,221 @@
+// src/Shader.cpp
+
+#include "Shader.h"
+#include "GLResources.h"
+#include "GLState.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <fstream>
+#include <iostream>
+
+GLuint LinkProgram(GLuint vs, GLuint fs, bool retrievable) 
+{
+    GLuint p = glCreateProgram();
+    if (retrievable && GLAD_GL_VERSION_4_1) {
+        glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(p, vs);
+    glAttachShader(p, fs);
+    glLinkProgram(p);
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLint logLength = 0;
+        glGetProgramiv(p, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> buf(logLength);
+        glGetProgramInfoLog(p, logLength, nullptr, buf.data());
+        std::cerr << "Program link error: " << buf.data() << "\n";
+        glDeleteProgram(p);
+        std::exit(-1);
+    }
+    glDetachShader(p, vs);
+    glDetachShader(p, fs);
+    return p;
+}
+
+std::string LoadShaderSource(const char* filepath) 
+{
+    std::string source;
+    if (!TryLoadShaderSource(filepath, source)) {
+        std::cerr << "Failed to open shader file: " << filepath << "\n";
+        std::exit(-1);
+    }
+    return source;
+}
+
+bool TryLoadShaderSource(const char* filepath, std::string& source)
+{
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if(!file) {
+        return false;
+    }
+
+    // Sized once and read straight into the string, no stringstream copy
+    std::streamoff size = file.tellg();
+    if (size < 0) return false;
+    source.resize((size_t)size);
+    file.seekg(0);
+    file.read(&source[0], size);
+    return (bool)file;
+}
+GLuint CompileShader(GLenum type, const char* src) 
+{
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint logLength = 0;
+        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> buf(logLength);
+        glGetShaderInfoLog(s, logLength, nullptr, buf.data());
+        std::cerr << "Shader compile error: " << buf.data() << "\n";
+        glDeleteShader(s);
+        std::exit(-1);
+    }
+    return s;
+}
+
+// "name[0]" -> "name", so arrays are looked up by their plain name
+static std::string StripArraySuffix(const char* name, GLsizei length) {
+    std::string s(name, length);
+    if (s.size() > 3 && s.compare(s.size() - 3, 3, "[0]") == 0) {
+        s.resize(s.size() - 3);
+    }
+    return s;
+}
+
+ShaderProgram CreateShaderProgram(GLuint vs, GLuint fs, bool retrievable) {
+    ShaderProgram program;
+    program.id = LinkProgram(vs, fs, retrievable);
+    ReflectProgram(program);
+    return program;
+}
+
+void ReflectProgram(ShaderProgram& program) {
+    GLuint p = program.id;
+    program.uniforms.clear();
+    program.attributes.clear();
+    program.blocks.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+
+    glGetProgramiv(p, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(p, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        ShaderUniform u;
+        glGetActiveUniform(p, (GLuint)i, maxLength, &length, &u.size, &u.type, name.data());
+        u.name = StripArraySuffix(name.data(), length);
+        u.location = glGetUniformLocation(p, name.data());
+        GLuint index = (GLuint)i;
+        glGetActiveUniformsiv(p, 1, &index, GL_UNIFORM_BLOCK_INDEX, &u.block);
+        program.uniforms.push_back(u);
+    }
+
+    glGetProgramiv(p, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(p, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.resize(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        ShaderAttribute a;
+        glGetActiveAttrib(p, (GLuint)i, maxLength, &length, &a.size, &a.type, name.data());
+        a.name = StripArraySuffix(name.data(), length);
+        a.location = glGetAttribLocation(p, name.data());
+        program.attributes.push_back(a);
+    }
+
+    glGetProgramiv(p, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(p, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(maxLength > 0 ? maxLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        ShaderBlock b;
+        b.index = (GLuint)i;
+        glGetActiveUniformBlockName(p, b.index, maxLength, &length, name.data());
+        b.name.assign(name.data(), length);
+        glGetActiveUniformBlockiv(p, b.index, GL_UNIFORM_BLOCK_DATA_SIZE, &b.dataSize);
+        program.blocks.push_back(b);
+    }
+}
+
+void DestroyShaderProgram(ShaderProgram& program) {
+    StateDeleteProgram(program.id);
+    program = ShaderProgram{};
+}
+
+void RetireShaderProgram(ShaderProgram& program) {
+    RetireGLName(GLResourceType::Program, program.id);
+    program = ShaderProgram{};
+}
+
+const ShaderUniform* FindUniform(const ShaderProgram& program, const char* name) {
+    for (const ShaderUniform& u : program.uniforms) {
+        if (u.name == name) return &u;
+    }
+    return nullptr;
+}
+
+const ShaderAttribute* FindAttribute(const ShaderProgram& program, const char* name) {
+    for (const ShaderAttribute& a : program.attributes) {
+        if (a.name == name) return &a;
+    }
+    return nullptr;
+}
+
+const ShaderBlock* FindBlock(const ShaderProgram& program, const char* name) {
+    for (const ShaderBlock& b : program.blocks) {
+        if (b.name == name) return &b;
+    }
+    return nullptr;
+}
+
+static bool IsIntLikeType(GLenum type) {
+    switch (type) {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_BUFFER:
+            return true;
+        default:
+            return false;
+    }
+}
+
+GLint ResolveUniform(const ShaderProgram& program, const char* name, GLenum expectedType) {
+    const ShaderUniform* u = FindUniform(program, name);
+    if (!u) return -1; // Not active, may have been optimized out
+
+    bool matches = u->type == expectedType || (expectedType == GL_INT && IsIntLikeType(u->type));
+    if (!matches) {
+        std::cerr << "Uniform " << name << " has GL type 0x" << std::hex << u->type
+                  << ", expected 0x" << expectedType << std::dec << "\n";
+    }
+    return u->location;
+}
+
+void SetUniform(UniformHandle<int> h, int value) {
+    glUniform1i(h.location, value);
+}
+void SetUniform(UniformHandle<float> h, float value) {
+    glUniform1f(h.location, value);
+}
+void SetUniform(UniformHandle<glm::vec2> h, const glm::vec2& value) {
+    glUniform2fv(h.location, 1, glm::value_ptr(value));
+}
+void SetUniform(UniformHandle<glm::vec3> h, const glm::vec3& value) {
+    glUniform3fv(h.location, 1, glm::value_ptr(value));
+}
+void SetUniform(UniformHandle<glm::vec4> h, const glm::vec4& value) {
+    glUniform4fv(h.location, 1, glm::value_ptr(value));
+}
+void SetUniform(UniformHandle<glm::mat4> h, const glm::mat4& value) {
+    glUniformMatrix4fv(h.location, 1, GL_FALSE, glm::value_ptr(value));
+}
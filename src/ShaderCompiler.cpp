@@ -0,0 +1,192 @@
+// src/ShaderCompiler.cpp
+
+#include "ShaderCompiler.h"
+
+#include <SDL3/SDL.h>
+
+#include <iomanip>
+#include <iostream>
+
+// GL_KHR_parallel_shader_compile, not part of the glad core profile we generate
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+static bool CheckShader(const ShaderJob& job, GLuint s, const char* stage) {
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint logLength = 0;
+        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> buf(logLength > 0 ? logLength : 1);
+        glGetShaderInfoLog(s, (GLsizei)buf.size(), nullptr, buf.data());
+        std::cerr << "Shader compile error (" << job.name << ", " << stage << "): " << buf.data() << "\n";
+    }
+    return ok;
+}
+
+static bool CheckProgram(const ShaderJob& job, GLuint p) {
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLint logLength = 0;
+        glGetProgramiv(p, GL_INFO_LOG_LENGTH, &logLength);
+        std::vector<char> buf(logLength > 0 ? logLength : 1);
+        glGetProgramInfoLog(p, (GLsizei)buf.size(), nullptr, buf.data());
+        std::cerr << "Program link error (" << job.name << "): " << buf.data() << "\n";
+    }
+    return ok;
+}
+
+static double MsSince(std::chrono::high_resolution_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - t).count();
+}
+
+// First status query for this job; only blocks if the driver isn't done yet.
+static void FinishJob(ShaderCompileBatch& batch, ShaderJob& job, size_t sourceJobs) {
+    GLuint p = job.program.id;
+    bool ok = CheckShader(job, job.vs, "vertex") & CheckShader(job, job.fs, "fragment");
+    ok = ok && CheckProgram(job, p);
+
+    glDetachShader(p, job.vs);
+    glDetachShader(p, job.fs);
+    glDeleteShader(job.vs);
+    glDeleteShader(job.fs);
+    job.vs = job.fs = 0;
+
+    double ms = MsSince(batch.start);
+    batch.wallMs = ms;
+    job.done = true;
+    job.ok = ok;
+    if (!ok) {
+        DestroyShaderProgram(job.program);
+        batch.failed++;
+        return;
+    }
+
+    ReflectProgram(job.program);
+    if (batch.cache) {
+        // Jobs overlap, so each is charged an even share of the wall time
+        ProgramCacheStore(*batch.cache, job.key, p, ms / sourceJobs);
+    }
+}
+
+static size_t CountSourceJobs(const ShaderCompileBatch& batch) {
+    size_t n = 0;
+    for (const ShaderJob& job : batch.jobs) {
+        if (!job.fromCache) n++;
+    }
+    return n > 0 ? n : 1;
+}
+
+void InitShaderCompileBatch(ShaderCompileBatch& batch, ProgramCache* cache) {
+    batch = ShaderCompileBatch{};
+    batch.cache = cache;
+
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile")) {
+        auto maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)SDL_GL_GetProcAddress(
+            "glMaxShaderCompilerThreadsKHR");
+        if (maxThreads) {
+            maxThreads(0xFFFFFFFFu); // Let the driver pick
+            batch.parallel = true;
+        }
+    }
+}
+
+size_t AddShaderJob(ShaderCompileBatch& batch, const std::string& name, const std::string& vertexSource,
+                    const std::string& fragmentSource, const std::string& defines) {
+    ShaderJob job;
+    job.name = name;
+    job.vertexSource = vertexSource;
+    job.fragmentSource = fragmentSource;
+    job.defines = defines;
+    batch.jobs.push_back(std::move(job));
+    return batch.jobs.size() - 1;
+}
+
+void SubmitShaderJobs(ShaderCompileBatch& batch) {
+    batch.start = std::chrono::high_resolution_clock::now();
+    batch.submitted = true;
+
+    // Cache hits are done right away
+    for (ShaderJob& job : batch.jobs) {
+        if (!batch.cache) break;
+        job.key = ProgramCacheKey(*batch.cache, job.vertexSource, job.fragmentSource, job.defines);
+        GLuint p = ProgramCacheLoad(*batch.cache, job.key);
+        if (p) {
+            job.program.id = p;
+            ReflectProgram(job.program);
+            job.fromCache = job.done = job.ok = true;
+        }
+    }
+
+    // Kick off every compile before touching any status
+    for (ShaderJob& job : batch.jobs) {
+        if (job.done) continue;
+        const char* vsrc = job.vertexSource.c_str();
+        const char* fsrc = job.fragmentSource.c_str();
+        job.vs = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(job.vs, 1, &vsrc, nullptr);
+        glCompileShader(job.vs);
+        job.fs = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(job.fs, 1, &fsrc, nullptr);
+        glCompileShader(job.fs);
+    }
+
+    // Then every link; a failed compile just makes the link fail too
+    bool retrievable = batch.cache && batch.cache->enabled;
+    for (ShaderJob& job : batch.jobs) {
+        if (job.done) continue;
+        GLuint p = glCreateProgram();
+        if (retrievable) {
+            glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glAttachShader(p, job.vs);
+        glAttachShader(p, job.fs);
+        glLinkProgram(p);
+        job.program.id = p;
+    }
+    batch.wallMs = MsSince(batch.start);
+}
+
+bool PollShaderJobs(ShaderCompileBatch& batch) {
+    if (!batch.submitted) SubmitShaderJobs(batch);
+
+    size_t sourceJobs = CountSourceJobs(batch);
+    bool allDone = true;
+    for (ShaderJob& job : batch.jobs) {
+        if (job.done) continue;
+        if (batch.parallel) {
+            GLint complete = GL_FALSE;
+            glGetProgramiv(job.program.id, GL_COMPLETION_STATUS_KHR, &complete);
+            if (!complete) {
+                allDone = false;
+                continue;
+            }
+        }
+        FinishJob(batch, job, sourceJobs);
+    }
+    return allDone;
+}
+
+void FinishShaderJobs(ShaderCompileBatch& batch) {
+    if (!batch.submitted) SubmitShaderJobs(batch);
+
+    size_t sourceJobs = CountSourceJobs(batch);
+    for (ShaderJob& job : batch.jobs) {
+        if (!job.done) FinishJob(batch, job, sourceJobs);
+    }
+}
+
+void PrintShaderCompileStats(const ShaderCompileBatch& batch) {
+    size_t cached = 0;
+    for (const ShaderJob& job : batch.jobs) {
+        if (job.fromCache) cached++;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "Shader compile: " << batch.jobs.size() << " programs (" << cached << " cached, "
+              << batch.failed << " failed) in " << batch.wallMs << " ms"
+              << (batch.parallel ? ", parallel" : "") << "\n"
+              << std::defaultfloat;
+}
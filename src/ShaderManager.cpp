@@ -0,0 +1,227 @@
+// src/ShaderManager.cpp
+
+#include "ShaderManager.h"
+
+#include <SDL3/SDL.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static const uint64_t kPollIntervalMs = 500;
+
+static std::string FilePath(const ShaderManager& sm, const std::string& file) {
+    return sm.directory + "/" + file;
+}
+
+static std::string Normalize(const fs::path& p) {
+    return p.lexically_normal().generic_string();
+}
+
+static void MarkFileChanged(ShaderManager& sm, const std::string& file) {
+    for (ShaderEntry& e : sm.entries) {
+        if (std::find(e.files.begin(), e.files.end(), file) != e.files.end()) e.dirty = true;
+    }
+}
+
+static int64_t FileTime(const std::string& path) {
+    std::error_code ec;
+    auto t = fs::last_write_time(path, ec);
+    return ec ? 0 : (int64_t)t.time_since_epoch().count();
+}
+
+static void WatchFiles(ShaderManager& sm) {
+#ifdef __linux__
+    if (sm.watchFd >= 0) {
+        alignas(inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = read(sm.watchFd, buf, sizeof(buf))) > 0) {
+            for (char* p = buf; p < buf + len;) {
+                const inotify_event* ev = (const inotify_event*)p;
+                if (ev->len > 0) {
+                    MarkFileChanged(sm, Normalize(fs::path(sm.watchDirs[ev->wd]) / ev->name));
+                }
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+        return;
+    }
+#endif
+    uint64_t now = SDL_GetTicks();
+    if (now - sm.lastPollTicks < kPollIntervalMs) return;
+    sm.lastPollTicks = now;
+    for (auto& [file, time] : sm.fileTimes) {
+        int64_t t = FileTime(FilePath(sm, file));
+        if (t != time) {
+            time = t;
+            MarkFileChanged(sm, file);
+        }
+    }
+}
+
+// Starts watching a dependency, including its directory if that's new.
+static void TrackFile(ShaderManager& sm, const std::string& file) {
+    if (sm.fileTimes.count(file)) return;
+    sm.fileTimes[file] = FileTime(FilePath(sm, file));
+#ifdef __linux__
+    if (sm.watchFd < 0) return;
+    std::string dir = Normalize(fs::path(file).parent_path());
+    if (dir == ".") dir.clear();
+    for (const auto& [wd, watched] : sm.watchDirs) {
+        if (watched == dir) return;
+    }
+    // Editors often save through a temp file and rename, hence IN_MOVED_TO
+    int wd = inotify_add_watch(sm.watchFd, FilePath(sm, dir).c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd >= 0) sm.watchDirs[wd] = dir;
+#endif
+}
+
+// Preprocesses both stages of an entry and queues it on the batch.
+static bool AddEntryJob(ShaderManager& sm, ShaderCompileBatch& batch, ShaderEntry& e) {
+    PreprocessedShader vertex;
+    PreprocessedShader fragment;
+    const std::string& version = e.glslVersion.empty() ? sm.version : e.glslVersion;
+    if (!PreprocessShader(sm.directory, e.vertexFile, e.defines, version, vertex) ||
+        !PreprocessShader(sm.directory, e.fragmentFile, e.defines, version, fragment)) {
+        std::cerr << "Shader '" << e.name << "': " << vertex.error << fragment.error << "\n";
+        return false;
+    }
+
+    // Keep the old dependencies too, a file dropped from an #include may come back
+    for (const std::vector<std::string>* files : {&vertex.files, &fragment.files}) {
+        for (const std::string& f : *files) {
+            if (std::find(e.files.begin(), e.files.end(), f) == e.files.end()) e.files.push_back(f);
+            TrackFile(sm, f);
+        }
+    }
+    AddShaderJob(batch, e.name, vertex.source, fragment.source, ShaderDefinesKey(e.defines));
+    return true;
+}
+
+void InitShaderManager(ShaderManager& sm, const char* directory, ProgramCache* cache) {
+    sm.directory = directory;
+    sm.cache = cache;
+
+#ifdef __linux__
+    sm.watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (sm.watchFd < 0) {
+        std::cerr << "ShaderManager: inotify unavailable, polling " << directory << "\n";
+    }
+#endif
+}
+
+void CleanupShaderManager(ShaderManager& sm) {
+    if (sm.reloading) {
+        FinishShaderJobs(sm.reload);
+        for (ShaderJob& job : sm.reload.jobs) DestroyShaderProgram(job.program);
+        sm.reloading = false;
+    }
+    for (ShaderEntry& e : sm.entries) DestroyShaderProgram(e.program);
+    sm.entries.clear();
+    sm.permutations.clear();
+#ifdef __linux__
+    if (sm.watchFd >= 0) close(sm.watchFd);
+    sm.watchFd = -1;
+    sm.watchDirs.clear();
+#endif
+}
+
+size_t AddShaderProgram(ShaderManager& sm, const std::string& name, const std::string& vertexFile,
+                        const std::string& fragmentFile, const ShaderDefines& defines,
+                        const std::string& glslVersion) {
+    std::string key = Normalize(vertexFile) + "|" + Normalize(fragmentFile) + "|" + ShaderDefinesKey(defines) +
+                      "|" + glslVersion;
+    auto it = sm.permutations.find(key);
+    if (it != sm.permutations.end()) return it->second;
+
+    ShaderEntry e;
+    e.name = name;
+    e.vertexFile = Normalize(vertexFile);
+    e.fragmentFile = Normalize(fragmentFile);
+    e.defines = defines;
+    e.glslVersion = glslVersion;
+    e.files = {e.vertexFile, e.fragmentFile};
+    sm.entries.push_back(std::move(e));
+
+    size_t index = sm.entries.size() - 1;
+    sm.permutations[key] = index;
+    return index;
+}
+
+bool LoadShaderPrograms(ShaderManager& sm) {
+    ShaderCompileBatch batch;
+    InitShaderCompileBatch(batch, sm.cache);
+    std::vector<size_t> jobEntries;
+    for (size_t i = 0; i < sm.entries.size(); i++) {
+        // Entries from an earlier call are already built
+        if (sm.entries[i].version > 0) continue;
+        if (!AddEntryJob(sm, batch, sm.entries[i])) return false;
+        jobEntries.push_back(i);
+    }
+    FinishShaderJobs(batch);
+    PrintShaderCompileStats(batch);
+
+    for (size_t i = 0; i < jobEntries.size(); i++) {
+        ShaderEntry& e = sm.entries[jobEntries[i]];
+        e.program = batch.jobs[i].program;
+        e.version++;
+    }
+    return batch.failed == 0;
+}
+
+void UpdateShaderManager(ShaderManager& sm) {
+    ZoneScoped;
+    WatchFiles(sm);
+
+    if (sm.reloading && PollShaderJobs(sm.reload)) {
+        for (size_t i = 0; i < sm.reload.jobs.size(); i++) {
+            ShaderJob& job = sm.reload.jobs[i];
+            ShaderEntry& e = sm.entries[sm.reloadEntries[i]];
+            if (job.ok) {
+                // Frames already submitted may still draw with the old one
+                RetireShaderProgram(e.program);
+                e.program = job.program;
+                e.version++;
+                std::cout << "Reloaded shader '" << e.name << "'\n";
+            } else {
+                std::cerr << "Shader '" << e.name << "' failed to reload, keeping previous version."
+                          << " Source numbers in the log index:";
+                for (size_t f = 0; f < e.files.size(); f++) std::cerr << " " << f << "=" << e.files[f];
+                std::cerr << "\n";
+            }
+        }
+        sm.reloading = false;
+    }
+
+    // Changes that land while a rebuild is in flight wait for the next one
+    if (sm.reloading) return;
+
+    bool anyDirty = false;
+    for (const ShaderEntry& e : sm.entries) anyDirty |= e.dirty;
+    if (!anyDirty) return;
+
+    InitShaderCompileBatch(sm.reload, sm.cache);
+    sm.reloadEntries.clear();
+    for (size_t i = 0; i < sm.entries.size(); i++) {
+        ShaderEntry& e = sm.entries[i];
+        if (!e.dirty) continue;
+        e.dirty = false;
+        if (AddEntryJob(sm, sm.reload, e)) sm.reloadEntries.push_back(i);
+    }
+    if (!sm.reloadEntries.empty()) {
+        SubmitShaderJobs(sm.reload);
+        sm.reloading = true;
+    }
+}
+
+const ShaderProgram& GetShaderProgram(const ShaderManager& sm, size_t index) {
+    return sm.entries[index].program;
+}
@@ -0,0 +1,138 @@
+// src/ShaderPreprocessor.cpp
+
+#include "ShaderPreprocessor.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+struct PreprocessContext {
+    std::string directory;
+    PreprocessedShader* out;
+    std::vector<std::string> stack; // Include chain, for cycle detection
+};
+
+static std::string Normalize(const fs::path& p) {
+    return p.lexically_normal().generic_string();
+}
+
+// Matches "#<directive>" with optional whitespace around the '#'; rest gets what follows.
+static bool MatchDirective(const std::string& line, const char* directive, std::string& rest) {
+    size_t i = line.find_first_not_of(" \t");
+    if (i == std::string::npos || line[i] != '#') return false;
+    i = line.find_first_not_of(" \t", i + 1);
+    if (i == std::string::npos) return false;
+    size_t len = std::char_traits<char>::length(directive);
+    if (line.compare(i, len, directive) != 0) return false;
+    rest = line.substr(i + len);
+    return true;
+}
+
+static size_t FileIndex(PreprocessedShader& out, const std::string& file) {
+    auto it = std::find(out.files.begin(), out.files.end(), file);
+    if (it != out.files.end()) return it - out.files.begin();
+    out.files.push_back(file);
+    return out.files.size() - 1;
+}
+
+static bool Expand(PreprocessContext& ctx, const std::string& file, std::string& source) {
+    PreprocessedShader& out = *ctx.out;
+    std::string text;
+    if (!TryLoadShaderSource((ctx.directory + "/" + file).c_str(), text)) {
+        out.error = "can't open " + file;
+        if (!ctx.stack.empty()) out.error += " (included from " + ctx.stack.back() + ")";
+        return false;
+    }
+    size_t index = FileIndex(out, file);
+    ctx.stack.push_back(file);
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(lines, line)) {
+        lineNo++;
+        std::string rest;
+        if (MatchDirective(line, "version", rest)) {
+            source += "\n"; // Emitted once at the top instead, blank keeps line numbers
+        } else if (MatchDirective(line, "include", rest)) {
+            size_t open = rest.find('"');
+            size_t close = open == std::string::npos ? open : rest.find('"', open + 1);
+            if (close == std::string::npos) {
+                out.error = file + ":" + std::to_string(lineNo) + ": malformed #include";
+                return false;
+            }
+            std::string target = Normalize(fs::path(file).parent_path() / rest.substr(open + 1, close - open - 1));
+            if (std::find(ctx.stack.begin(), ctx.stack.end(), target) != ctx.stack.end()) {
+                out.error = file + ":" + std::to_string(lineNo) + ": recursive #include of " + target;
+                return false;
+            }
+            bool seen = std::find(out.files.begin(), out.files.end(), target) != out.files.end();
+            if (!seen) {
+                source += "#line 1 " + std::to_string(out.files.size()) + "\n";
+                if (!Expand(ctx, target, source)) return false;
+            }
+            source += "#line " + std::to_string(lineNo + 1) + " " + std::to_string(index) + "\n";
+        } else {
+            source += line;
+            source += "\n";
+        }
+    }
+
+    ctx.stack.pop_back();
+    return true;
+}
+
+std::string ShaderDefinesKey(const ShaderDefines& defines) {
+    ShaderDefines sorted = defines;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+    std::string key;
+    for (const ShaderDefine& d : sorted) {
+        key += d.name;
+        if (!d.value.empty()) key += "=" + d.value;
+        key += ";";
+    }
+    return key;
+}
+
+bool PreprocessShader(const std::string& directory, const std::string& file, const ShaderDefines& defines,
+                      const std::string& version, PreprocessedShader& out) {
+    out = PreprocessedShader{};
+    PreprocessContext ctx;
+    ctx.directory = directory;
+    ctx.out = &out;
+
+    std::string body;
+    std::string root = Normalize(file);
+    if (!Expand(ctx, root, body)) {
+        out.source.clear();
+        return false;
+    }
+
+    std::string versionLine = version;
+    if (versionLine.empty()) {
+        // Keep the root file's own #version
+        std::string text;
+        TryLoadShaderSource((directory + "/" + root).c_str(), text);
+        std::istringstream lines(text);
+        std::string line;
+        std::string rest;
+        while (std::getline(lines, line)) {
+            if (MatchDirective(line, "version", rest)) {
+                versionLine = line;
+                break;
+            }
+        }
+    }
+
+    if (!versionLine.empty()) out.source += versionLine + "\n";
+    for (const ShaderDefine& d : defines) {
+        out.source += "#define " + d.name + (d.value.empty() ? "" : " " + d.value) + "\n";
+    }
+    out.source += "#line 1 0\n";
+    out.source += body;
+    return true;
+}
@@ -0,0 +1,51 @@
+// src/SimClock.cpp
+
+#include "SimClock.h"
+
+#include <algorithm>
+
+static const double kNsPerSecond = 1e9;
+
+void InitSimClock(SimClock& c, double tickRate, uint64_t nowNs) {
+    SetSimTickRate(c, tickRate);
+    c.lastNs = nowNs;
+    c.accumulatorNs = 0;
+    c.tick = 0;
+    c.simNs = 0;
+    c.droppedNs = 0;
+    c.alpha = 0.0;
+}
+
+void SetSimTickRate(SimClock& c, double tickRate) {
+    c.stepNs = std::max<uint64_t>(1, (uint64_t)(kNsPerSecond / tickRate));
+}
+
+int AdvanceSimClock(SimClock& c, uint64_t nowNs) {
+    c.accumulatorNs += nowNs > c.lastNs ? nowNs - c.lastNs : 0;
+    c.lastNs = nowNs;
+
+    uint64_t steps = c.accumulatorNs / c.stepNs;
+    if (steps > (uint64_t)c.maxSteps) {
+        // Keep the fraction so alpha stays continuous, drop whole steps
+        c.droppedNs += (steps - c.maxSteps) * c.stepNs;
+        steps = c.maxSteps;
+    }
+    c.accumulatorNs %= c.stepNs;
+    c.tick += steps;
+    c.simNs += steps * c.stepNs;
+    c.alpha = (double)c.accumulatorNs / c.stepNs;
+    return (int)steps;
+}
+
+double SimStepSeconds(const SimClock& c) {
+    return c.stepNs / kNsPerSecond;
+}
+
+double SimSeconds(const SimClock& c) {
+    // Split so simNs can't overflow the double's mantissa for any realistic uptime
+    return (double)(c.simNs / 1000000000ull) + (double)(c.simNs % 1000000000ull) / kNsPerSecond;
+}
+
+double SimTickRate(const SimClock& c) {
+    return kNsPerSecond / c.stepNs;
+}
@@ -0,0 +1,141 @@
+// src/StreamBuffer.cpp
+
+#include "StreamBuffer.h"
+#include "GLState.h"
+
+#include <iostream>
+
+#include <tracy/Tracy.hpp>
+
+static size_t RoundUp(size_t value, size_t alignment) {
+    if (alignment <= 1) return value;
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static void WaitFence(StreamBuffer& sb, GLsync& fence) {
+    if (!fence) return;
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        ZoneScopedN("Stream fence wait");
+        sb.stats.fenceWaits++;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "StreamBuffer: glClientWaitSync failed\n";
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+// Hands the current segment to the GPU and moves head to the start of the next one.
+static void AdvanceSegment(StreamBuffer& sb) {
+    if (sb.persistent) {
+        sb.fences[sb.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        sb.segment = (sb.segment + 1) % sb.segmentCount;
+        WaitFence(sb, sb.fences[sb.segment]);
+    } else {
+        sb.segment = (sb.segment + 1) % sb.segmentCount;
+        if (sb.segment == 0) {
+            // Wrapped: give the old storage to the driver instead of waiting on it
+            StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+            glBufferData(GL_COPY_WRITE_BUFFER, sb.size, nullptr, GL_STREAM_DRAW);
+            sb.stats.orphans++;
+        }
+    }
+    sb.head = sb.segment * sb.segmentSize;
+}
+
+void InitStreamBuffer(StreamBuffer& sb, size_t segmentSize, int segments) {
+    if (segments < 2) segments = 2;
+    if (segments > kStreamMaxSegments) segments = kStreamMaxSegments;
+
+    sb.segmentCount = segments;
+    sb.segmentSize = segmentSize;
+    sb.size = segmentSize * segments;
+    sb.head = 0;
+    sb.segment = 0;
+    sb.stats = StreamStats{};
+
+    // GL_COPY_WRITE_BUFFER is used for all internal binds so we never touch
+    // the element buffer binding of whatever VAO is currently bound
+    sb.buffer = CreateGLResource<GLResourceType::Buffer>("Stream");
+    StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+
+    sb.persistent = false;
+    if (GLAD_GL_VERSION_4_4) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, sb.size, nullptr, flags);
+        sb.mapped = (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, sb.size, flags);
+        if (sb.mapped) {
+            sb.persistent = true;
+        } else {
+            // Storage is immutable now, so start over with a fresh buffer
+            std::cerr << "StreamBuffer: persistent map failed, falling back to orphaning\n";
+            DestroyGLResource(sb.buffer);
+            sb.buffer = CreateGLResource<GLResourceType::Buffer>("Stream");
+            StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+        }
+    }
+    if (!sb.persistent) {
+        glBufferData(GL_COPY_WRITE_BUFFER, sb.size, nullptr, GL_STREAM_DRAW);
+    }
+    SetGLResourceBytes(sb.buffer, sb.size);
+}
+
+void CleanupStreamBuffer(StreamBuffer& sb) {
+    for (int i = 0; i < kStreamMaxSegments; i++) {
+        if (sb.fences[i]) glDeleteSync(sb.fences[i]);
+        sb.fences[i] = nullptr;
+    }
+    if (sb.persistent && sb.mapped) {
+        StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    DestroyGLResource(sb.buffer);
+    sb.mapped = nullptr;
+}
+
+StreamAllocation StreamAlloc(StreamBuffer& sb, size_t size, size_t alignment) {
+    StreamAllocation alloc;
+    if (size == 0 || size > sb.segmentSize) return alloc;
+
+    if (!StreamFits(sb, size, alignment)) {
+        AdvanceSegment(sb);
+        if (!StreamFits(sb, size, alignment)) return alloc; // Alignment ate the slack
+    }
+    size_t offset = RoundUp(sb.head, alignment);
+
+    alloc.offset = offset;
+    alloc.size = size;
+    sb.head = offset + size;
+    sb.stats.bytesAllocated += size;
+
+    if (sb.persistent) {
+        alloc.ptr = sb.mapped + offset;
+    } else {
+        // Every range is written once between orphans, so no sync is needed
+        StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+        alloc.ptr = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                     GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    return alloc;
+}
+
+bool StreamFits(const StreamBuffer& sb, size_t size, size_t alignment) {
+    size_t segmentEnd = (sb.segment + 1) * sb.segmentSize;
+    return RoundUp(sb.head, alignment) + size <= segmentEnd;
+}
+
+void StreamCommit(StreamBuffer& sb, const StreamAllocation& alloc) {
+    if (sb.persistent || !alloc.ptr) return; // Coherent mapping, nothing to flush
+    StateBindBuffer(GL_COPY_WRITE_BUFFER, GLName(sb.buffer));
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+
+void StreamEndFrame(StreamBuffer& sb) {
+    if (sb.head == (size_t)sb.segment * sb.segmentSize) return; // Nothing written
+    AdvanceSegment(sb);
+}
@@ -0,0 +1,248 @@
+// src/VertexFormat.cpp
+
+#include "VertexFormat.h"
+#include "GLState.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+struct VertexArrayEntry {
+    uint64_t hash = 0;
+    BufferHandle indexBuffer;
+    VertexFormat format;
+    VertexArrayHandle vao;
+    BufferHandle buffers[kVertexMaxBindings]; // What each binding points at
+    size_t offsets[kVertexMaxBindings] = {};
+};
+
+// A handful of formats, so a linear search over the hashes
+struct VertexFormatCache {
+    std::vector<VertexArrayEntry> entries;
+    int current = -1; // Entry of the last BindVertexFormat
+    VertexFormatStats stats;
+    bool forcePointers = false;
+};
+
+static VertexFormatCache s_cache;
+
+// glVertexAttribFormat and glBindVertexBuffer, GL 4.3
+static bool SeparateFormat() {
+    return GLAD_GL_VERSION_4_3 && !s_cache.forcePointers;
+}
+
+static GLenum GLType(VertexAttribType type) {
+    switch (type) {
+        case VertexAttribType::Float: return GL_FLOAT;
+        case VertexAttribType::Half: return GL_HALF_FLOAT;
+        case VertexAttribType::UNorm8: return GL_UNSIGNED_BYTE;
+        case VertexAttribType::SNorm8: return GL_BYTE;
+        case VertexAttribType::UNorm16: return GL_UNSIGNED_SHORT;
+        case VertexAttribType::SNorm16: return GL_SHORT;
+        case VertexAttribType::UNorm10_10_10_2: return GL_UNSIGNED_INT_2_10_10_10_REV;
+        case VertexAttribType::SNorm10_10_10_2: return GL_INT_2_10_10_10_REV;
+        case VertexAttribType::UInt: return GL_UNSIGNED_INT;
+        default: return GL_FLOAT;
+    }
+}
+
+static bool IsPacked(VertexAttribType type) {
+    return type == VertexAttribType::UNorm10_10_10_2 || type == VertexAttribType::SNorm10_10_10_2;
+}
+
+static GLboolean IsNormalized(VertexAttribType type) {
+    return type != VertexAttribType::Float && type != VertexAttribType::Half && type != VertexAttribType::UInt;
+}
+
+size_t VertexAttribSize(VertexAttribType type, uint8_t components) {
+    switch (type) {
+        case VertexAttribType::UNorm8:
+        case VertexAttribType::SNorm8: return components;
+        case VertexAttribType::Half:
+        case VertexAttribType::UNorm16:
+        case VertexAttribType::SNorm16: return components * 2;
+        case VertexAttribType::UNorm10_10_10_2:
+        case VertexAttribType::SNorm10_10_10_2: return 4;
+        default: return components * 4;
+    }
+}
+
+uint32_t AddVertexBinding(VertexFormat& format, uint16_t stride, uint16_t divisor) {
+    if (format.bindingCount >= kVertexMaxBindings) {
+        std::cerr << "VertexFormat: more than " << kVertexMaxBindings << " bindings\n";
+        std::exit(-1);
+    }
+    format.bindings[format.bindingCount] = VertexBinding{stride, divisor};
+    const uint16_t fields[] = {0xB, stride, divisor};
+    format.hash = HashBytes(fields, sizeof(fields), format.hash);
+    return format.bindingCount++;
+}
+
+void AddVertexAttrib(VertexFormat& format, uint8_t location, VertexAttribType type, uint8_t components,
+                     uint16_t offset, uint8_t binding) {
+    if (format.attribCount >= kVertexMaxAttribs || binding >= format.bindingCount) {
+        std::cerr << "VertexFormat: attribute " << (int)location << " exceeds " << kVertexMaxAttribs
+                  << " attributes or uses binding " << (int)binding << " before it was added\n";
+        std::exit(-1);
+    }
+    if (IsPacked(type) && components != 4) {
+        std::cerr << "VertexFormat: packed attribute " << (int)location << " has 4 components, not "
+                  << (int)components << "\n";
+        components = 4;
+    }
+    if (offset + VertexAttribSize(type, components) > format.bindings[binding].stride) {
+        std::cerr << "VertexFormat: attribute " << (int)location << " runs past the stride of binding "
+                  << (int)binding << "\n";
+    }
+    format.attribs[format.attribCount++] = VertexAttrib{location, type, components, binding, offset};
+    const uint16_t fields[] = {0xA, location, (uint16_t)type, components, binding, offset};
+    format.hash = HashBytes(fields, sizeof(fields), format.hash);
+}
+
+// The hash picks the entry, this makes sure a collision can't hand out the
+// VAO of another layout.
+static bool SameFormat(const VertexFormat& a, const VertexFormat& b) {
+    if (a.attribCount != b.attribCount || a.bindingCount != b.bindingCount) return false;
+    for (int i = 0; i < a.attribCount; i++) {
+        const VertexAttrib& x = a.attribs[i];
+        const VertexAttrib& y = b.attribs[i];
+        if (x.location != y.location || x.type != y.type || x.components != y.components ||
+            x.binding != y.binding || x.offset != y.offset) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a.bindingCount; i++) {
+        if (a.bindings[i].stride != b.bindings[i].stride || a.bindings[i].divisor != b.bindings[i].divisor) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Layout that stays with the VAO; buffers come with BindVertexBuffer.
+static void SetupVertexArray(const VertexFormat& format) {
+    for (int i = 0; i < format.attribCount; i++) {
+        const VertexAttrib& a = format.attribs[i];
+        glEnableVertexAttribArray(a.location);
+        if (SeparateFormat()) {
+            if (a.type == VertexAttribType::UInt) {
+                glVertexAttribIFormat(a.location, a.components, GL_UNSIGNED_INT, a.offset);
+            } else {
+                glVertexAttribFormat(a.location, a.components, GLType(a.type), IsNormalized(a.type), a.offset);
+            }
+            glVertexAttribBinding(a.location, a.binding);
+        } else {
+            glVertexAttribDivisor(a.location, format.bindings[a.binding].divisor);
+        }
+    }
+    if (SeparateFormat()) {
+        for (int b = 0; b < format.bindingCount; b++) glVertexBindingDivisor(b, format.bindings[b].divisor);
+    }
+}
+
+GLuint BindVertexFormat(const VertexFormat& format, BufferHandle indexBuffer) {
+    VertexFormatCache& cache = s_cache;
+    int found = -1;
+    for (size_t i = 0; i < cache.entries.size(); i++) {
+        const VertexArrayEntry& e = cache.entries[i];
+        if (e.hash == format.hash && e.indexBuffer == indexBuffer && SameFormat(e.format, format)) {
+            found = (int)i;
+            break;
+        }
+    }
+    if (found < 0) {
+        VertexArrayEntry e;
+        e.hash = format.hash;
+        e.indexBuffer = indexBuffer;
+        e.format = format;
+        e.vao = CreateGLResource<GLResourceType::VertexArray>("Vertex format");
+        StateBindVertexArray(GLName(e.vao));
+        SetupVertexArray(format);
+        // The element buffer binding is VAO state, so bind it while the VAO is bound
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GLName(indexBuffer));
+        found = (int)cache.entries.size();
+        cache.entries.push_back(e);
+        cache.stats.vertexArrays++;
+    }
+    cache.current = found;
+    GLuint vao = GLName(cache.entries[found].vao);
+    StateBindVertexArray(vao);
+    return vao;
+}
+
+void BindVertexBuffer(uint32_t binding, BufferHandle buffer, size_t offset) {
+    VertexFormatCache& cache = s_cache;
+    if (cache.current < 0) {
+        std::cerr << "BindVertexBuffer: no vertex format bound\n";
+        return;
+    }
+    VertexArrayEntry& e = cache.entries[cache.current];
+    const VertexFormat& format = e.format;
+    if (binding >= format.bindingCount) {
+        std::cerr << "BindVertexBuffer: format has no binding " << binding << "\n";
+        return;
+    }
+    StateBindVertexArray(GLName(e.vao));
+    if (e.buffers[binding] == buffer && e.offsets[binding] == offset) {
+        cache.stats.bufferBindsElided++;
+        return;
+    }
+    e.buffers[binding] = buffer;
+    e.offsets[binding] = offset;
+    cache.stats.bufferBinds++;
+
+    GLuint name = GLName(buffer);
+    GLsizei stride = format.bindings[binding].stride;
+    if (SeparateFormat()) {
+        glBindVertexBuffer(binding, name, (GLintptr)offset, stride);
+        return;
+    }
+    // Attribute pointers capture the buffer bound to GL_ARRAY_BUFFER
+    StateBindBuffer(GL_ARRAY_BUFFER, name);
+    for (int i = 0; i < format.attribCount; i++) {
+        const VertexAttrib& a = format.attribs[i];
+        if (a.binding != binding) continue;
+        void* pointer = (void*)(offset + a.offset);
+        if (a.type == VertexAttribType::UInt) {
+            glVertexAttribIPointer(a.location, a.components, GL_UNSIGNED_INT, stride, pointer);
+        } else {
+            glVertexAttribPointer(a.location, a.components, GLType(a.type), IsNormalized(a.type), stride, pointer);
+        }
+    }
+}
+
+void ReleaseVertexArrays(BufferHandle indexBuffer) {
+    VertexFormatCache& cache = s_cache;
+    for (size_t i = 0; i < cache.entries.size();) {
+        if (cache.entries[i].indexBuffer != indexBuffer) {
+            i++;
+            continue;
+        }
+        DestroyGLResource(cache.entries[i].vao);
+        cache.entries[i] = cache.entries.back();
+        cache.entries.pop_back();
+        cache.stats.vertexArrays--;
+        cache.current = -1;
+    }
+}
+
+void CleanupVertexFormats() {
+    for (VertexArrayEntry& e : s_cache.entries) DestroyGLResource(e.vao);
+    s_cache.entries.clear();
+    s_cache.current = -1;
+    s_cache.stats.vertexArrays = 0;
+}
+
+void ForceVertexAttribPointers(bool force) {
+    s_cache.forcePointers = force;
+}
+
+VertexFormatStats GetVertexFormatStats() {
+    return s_cache.stats;
+}
+
+void PrintVertexFormatStats() {
+    const VertexFormatStats& stats = s_cache.stats;
+    std::cout << "Vertex formats: " << stats.vertexArrays << " VAOs cached; " << stats.bufferBinds
+              << " buffer binds, " << stats.bufferBindsElided << " elided\n";
+}
@@ -5,6 +5,7 @@
 #include <glad/glad.h>
 // --- New Includes ---
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/type_ptr.hpp> // For glm::value_ptr
 #include "SDL3/SDL_error.h"
 #include "SDL3/SDL_log.h"
@@ -13,159 +14,388 @@
 #include "imgui_impl_opengl3.h"
 #include "imgui_impl_sdl3.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
-#include <fstream>
-#include <sstream>
-
 //profiling
 #include <tracy/Tracy.hpp>
+#include <tracy/TracyOpenGL.hpp> // Needs the GL functions from glad declared first
+
+#include "AllocTracker.h"
+#include "BatchRenderer.h"
+#include "FrameArena.h"
+#include "FramePacer.h"
+#include "FrameTimes.h"
+#include "GLResources.h"
+#include "GLState.h"
+#include "GpuProfiler.h"
+#include "InstanceRenderer.h"
+#include "JobSystem.h"
+#include "Platform.h"
+#include "ProgramCache.h"
+#include "RenderTarget.h"
+#include "RenderThread.h"
+#include "ShaderManager.h"
+#include "SimClock.h"
+#include "Shader.h"
+#include "VertexFormat.h"
+
+// Command line and environment options
+struct AppOptions {
+    bool headless = false; // Hidden window on the offscreen driver, drawing into an FBO
+    int frames = 0;        // Exit after this many frames, 0 runs until closed
+    int shapes = 0;        // Initial shape count
+    PacingMode pacing = PacingMode::Vsync; // Uncapped when headless unless --pacing is given
+    double fps = 0.0;      // Limited mode's cap, 0 keeps the pacer's default
+    int maxInFlight = -1;  // Frames queued on the GPU, -1 keeps the pacer's default
+    double tickRate = 60.0; // Simulation steps per second
+    bool renderThread = kRenderThreadSupported; // --single-thread and --render-thread override
+    bool allocCheck = false; // Report every frame that allocates after the warm up
+    int workers = -1;      // Job system workers, -1 for one per core minus one
+    bool pinWorkers = false;
+};
 
-/*
-* Load Shader File. Located in src/shaders.
-*/
-std::string LoadShaderSource(const char* filepath);
+AppOptions ParseOptions(int argc, char** argv);
 
-static GLuint CompileShader(GLenum type, const char* src);
-static GLuint LinkProgram(GLuint vs, GLuint fs);
+static const int kFrameTimeGraph = 240; // Recent frames in the frame time graph
+static const int kAllocWarmupFrames = 30; // Frames before allocations count against the steady state
+static const size_t kPacketArenaSize = 1 << 20; // Starting size, grows to what frames need
+
+// Everything the UI changes, copied into every frame packet
+struct AppSettings {
+    glm::vec4 clearColor = glm::vec4(0.1f, 0.1f, 0.12f, 1.0f);
+    glm::vec4 triangleColor = glm::vec4(1.0f, 0.5f, 0.1f, 1.0f);
+    int shapeCount = 0; // Extra shapes drawn behind the triangle
+    bool instanced = true;
+    bool interpolate = true;
+    PacingMode pacing = PacingMode::Vsync; // Requested, the pacer may fall back
+    double targetFps = 0.0;
+    int maxFramesInFlight = 0;
+};
 
-void SetGLAttributes();
-void InitSDL();
+// What the render thread reports back about a frame it drew
+struct RenderResults {
+    BatchStats batch;
+    InstanceStats instances;
+    DrawQueueStats queue;
+    GLStateCounters glState;
+    uint64_t uploadBytes = 0; // Written to stream buffers this frame
+    // GPU timings, copied out of the profiler whose queries stay on the render thread
+    bool gpuEnabled = false;
+    std::vector<GpuTiming> gpuTimings;
+    float gpuHistory[kGpuProfilerHistory] = {};
+    int gpuHistoryHead = 0;
+    uint32_t gpuDropped = 0;
+    PacingMode pacing = PacingMode::Vsync; // In effect
+    bool adaptiveSupported = true;
+    double latencyMs = 0.0;
+    uint64_t capWaits = 0;
+};
 
-struct GLContext {
-    SDL_Window* window;
-    SDL_GLContext context;
+// Latest numbers, shown in the settings window
+struct FrameStats {
+    RenderResults render; // Two frames old, from the packet that last came back
+    RenderThreadStats thread;
+    FrameTimeSummary frameTimes;
+    float recentFrames[kFrameTimeGraph] = {}; // Newest last, zeros until the ring has filled
 };
 
-GLContext InitSDLGL(const char* title, int width, int height);
-void PrintGLInfo();
-ImGuiIO& InitIMGUI(GLContext gl);
-void CleanupImgui();
-void CleanupSDL(GLContext gl);
-void ConfigImgui(ImGuiIO& io, glm::vec4 shapeColor, glm::vec4 clearColor);
-void SetupTriangle();
+// Simulated state, advanced in fixed steps and interpolated for rendering
+struct SceneState {
+    double spin = 0.0; // Radians, wrapped to [0, 2pi)
+};
+
+// One frame for the render thread. The main thread fills in the first
+// part and doesn't touch the packet again until it comes back; the render
+// thread only writes results.
+struct FramePacket {
+    uint64_t frame = 0;
+    uint64_t sampled = 0; // Performance counter when input was polled
+    int width = 0; // Drawable size in pixels
+    int height = 0;
+    AppSettings settings;
+    float spin = 0.0f; // Interpolated simulation state
+    InstanceData* shapes = nullptr; // Background grid in arena, odd ones are circles with radius transform.z
+    uint32_t shapeCount = 0;
+    ImDrawData drawData; // Points into drawLists
+    ImVector<ImDrawList*> drawLists; // Owned, buffers swapped with ImGui's every frame
+
+    RenderResults results;
+    LinearArena arena; // Transient data of this frame, reset when the main thread takes the packet again
+};
+
+// Instanced meshes for the background grid; renderer is null when the grid is batched
+struct InstancedScene {
+    InstanceRenderer* renderer = nullptr;
+    size_t rectMesh = 0;
+    size_t circleMesh = 0;
+};
+
+// GL side of the app. Created and destroyed on the main thread, used only
+// by the render thread in between.
+struct Renderer {
+    bool headless = false;
+    GLContext gl{};
+    RenderTarget renderTarget;
+    ShaderManager shaders;
+    BatchRenderer batch;
+    DrawQueue drawQueue;
+    InstanceRenderer instances;
+    InstancedScene instancedScene;
+    GpuProfiler gpuProfiler;
+    FramePacer pacer;
+    PacingMode requestedPacing = PacingMode::Vsync; // Last mode asked for, so a fallback isn't retried every frame
+    int packetsQueued = 0; // Packets that may wait behind the one being drawn
+    uint64_t streamedBytes = 0;
+};
+
+void ConfigImgui(ImGuiIO& io, AppSettings& settings, const FrameStats& stats, const FramePacer& pacer,
+                 SimClock& simClock);
+void DrawFramePacing(AppSettings& settings, const FrameStats& stats, const FramePacer& pacer);
+void DrawSimulation(SimClock& simClock, bool& interpolate);
+void StepScene(SceneState& state, double dt);
+SceneState LerpScene(const SceneState& previous, const SceneState& current, double alpha);
+void DrawGpuProfile(const RenderResults& results);
+void DrawFrameTimes(const FrameStats& stats);
+InstanceData* AnimateGrid(JobSystem& jobs, LinearArena& arena, float spin, uint32_t shapeCount);
+void SubmitScene(BatchRenderer& batch, const InstancedScene& scene, const InstanceData* shapes,
+                 uint32_t shapeCount, float spin, glm::vec4 triangleColor);
+uint64_t StreamedBytes(const BatchRenderer& batch, const InstanceRenderer& instances);
+void TakeDrawData(FramePacket& packet);
+void FreeDrawLists(FramePacket& packet);
+void RenderFrame(void* user, void* data);
 
 int main(int argc, char** argv) {
 	ZoneScoped;
 	ZoneName("Main Function", sizeof("Main Function"));
 
     //************************INIT PROGRAM*****************************
-    InitSDL();
+    AppOptions options = ParseOptions(argc, argv);
+    SetAllocCheck(options.allocCheck, kAllocWarmupFrames);
+    InitSDL(options.headless);
     SetGLAttributes();
-    GLContext gl = InitSDLGL("Dematik", 1024, 768);
+    GLContext gl = InitSDLGL("Dematik", 1024, 768, options.headless);
     PrintGLInfo();
+    //Worker threads for data parallel frame work; this thread helps while it waits
+    JobSystem jobs;
+    InitJobSystem(jobs, options.workers, options.pinWorkers);
+    Renderer renderer;
+    renderer.headless = options.headless;
+    renderer.gl = gl;
+    //Headless runs draw into an FBO, the default framebuffer is never shown
+    if (options.headless) {
+        int w_px, h_px;
+        SDL_GetWindowSizeInPixels(gl.window, &w_px, &h_px);
+        if (!InitRenderTarget(renderer.renderTarget, w_px, h_px)) {
+            CleanupSDL(gl);
+            std::exit(-1);
+        }
+        std::cout << "Headless: " << w_px << "x" << h_px << ", " << options.frames << " frames\n";
+    }
+    //GPU zones are timed with GL timer queries on this context
+    TracyGpuContext;
+    TracyPlotConfig("Uploaded bytes", tracy::PlotFormatType::Memory, false, true, 0);
+    //Built-in GPU pass timings, shown in the settings window
+    InitGpuProfiler(renderer.gpuProfiler);
     //Init IMGUI
     ImGuiIO& io = InitIMGUI(gl);
 
     //*************************SHADER STUFF******************************
 
-    //Load shaders from file
-    std::string vertexSource = LoadShaderSource("src/shaders/vertex.glsl");
-    std::string fragmentSource = LoadShaderSource("src/shaders/fragment.glsl");
-
-    //Compile Shaders
-    GLuint vs = CompileShader(GL_VERTEX_SHADER, vertexSource.c_str());
-    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fragmentSource.c_str());
-
-    //Link Shaders
-    GLuint program = LinkProgram(vs, fs);
-    glDeleteShader(vs); // Delete shaders after linking
-    glDeleteShader(fs);
-    
-
-    //Setup triangle
-    //void SetupTriangle();
-
-    // --- Triangle Data ---
-    float triVerts[] = {
-        0.0f,  0.5f,  // Top
-        -0.5f, -0.5f, // Left
-        0.5f,  -0.5f  // Right
-    };
-
-    //Vertex array object, vertex buffer object
-    GLuint vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(triVerts), triVerts, GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
-                          (void*)0);
-
-    auto t0 = std::chrono::high_resolution_clock::now();
-    glm::vec4 clearColor = glm::vec4(0.1f, 0.1f, 0.12f, 1.0f);
-    glm::vec4 triangleColor = glm::vec4(1.0f, 0.5f, 0.1f, 1.0f); // Initial color
+    //Load shaders from src/shaders, or their binaries from a previous run.
+    //Edits to the files are picked up while the app runs.
+    ProgramCache programCache;
+    InitProgramCache(programCache, "shader_cache");
+    ShaderManager& shaders = renderer.shaders;
+    InitShaderManager(shaders, "src/shaders", &programCache);
+    size_t mainShader = AddShaderProgram(shaders, "main", "vertex.glsl", "fragment.glsl");
+    size_t instancedShader = AddShaderProgram(shaders, "instanced", "vertex.glsl", "fragment.glsl",
+                                              {{"INSTANCED", ""}});
+    //Multi-draw indirect variant reads instances from an SSBO, so it needs GL 4.3
+    size_t indirectShader = 0;
+    if (GLAD_GL_VERSION_4_3) {
+        indirectShader = AddShaderProgram(shaders, "indirect", "vertex.glsl", "fragment.glsl",
+                                          {{"INSTANCED", ""}, {"INDIRECT", ""}}, "#version 430 core");
+    }
+    if (!LoadShaderPrograms(shaders)) {
+        std::exit(-1);
+    }
+    PrintProgramCacheStats(programCache);
+
+    //Setup batch renderer
+    InitBatchRenderer(renderer.batch, GetShaderProgram(shaders, mainShader));
+    ReserveDrawQueue(renderer.drawQueue, 1024);
+    renderer.batch.queue = &renderer.drawQueue; // Draws are sorted by program/material before they are issued
+    //Setup instanced renderer, used for the background grid when enabled
+    InitInstanceRenderer(renderer.instances, GetShaderProgram(shaders, instancedShader), 1 << 16,
+                         GLAD_GL_VERSION_4_3 ? &GetShaderProgram(shaders, indirectShader) : nullptr);
+    renderer.instancedScene.rectMesh = AddInstanceRectMesh(renderer.instances);
+    renderer.instancedScene.circleMesh = AddInstanceCircleMesh(renderer.instances, 8);
+    renderer.streamedBytes = StreamedBytes(renderer.batch, renderer.instances);
+    FrameStats frameStats;
+
+    //Frame times against the display's refresh interval
+    FrameTimeRing frameTimes;
+    const SDL_DisplayMode* displayMode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(gl.window));
+    double refreshRate = displayMode && displayMode->refresh_rate > 0.0f ? displayMode->refresh_rate : 60.0;
+    ResetFrameTimes(frameTimes, 1000.0 / refreshRate);
+    //Swap interval, frame cap and how far the CPU may run ahead of the GPU
+    FramePacer& pacer = renderer.pacer;
+    if (options.fps > 0.0) pacer.targetFps = options.fps;
+    if (options.maxInFlight >= 0) pacer.maxFramesInFlight = options.maxInFlight;
+    InitFramePacer(pacer, options.pacing, refreshRate);
+    renderer.requestedPacing = options.pacing;
+
+    AppSettings settings;
+    settings.shapeCount = options.shapes;
+    settings.pacing = options.pacing;
+    settings.targetFps = pacer.targetFps;
+    settings.maxFramesInFlight = pacer.maxFramesInFlight;
+
+    auto tFrame = std::chrono::high_resolution_clock::now(); // Previous frame's t1
+    //Simulation runs at its own fixed rate; headless runs take exactly one step per frame
+    SimClock simClock;
+    InitSimClock(simClock, options.tickRate, options.headless ? 0 : SDL_GetTicksNS());
+    SceneState previousState;
+    SceneState currentState;
+
+    //GL moves to the render thread from here on, until StopRenderThread
+    FramePacket packets[kRenderPackets];
+    for (FramePacket& p : packets) InitArena(p.arena, "Packet arena", kPacketArenaSize);
+    RenderThread renderThread;
+    StartRenderThread(renderThread, gl, RenderFrame, &renderer, &packets[0], &packets[1], options.renderThread);
+    renderer.packetsQueued = renderThread.thread ? kRenderPackets - 1 : 0;
 
     //***************************GAMELOOP***************************
     bool running = true;
+    int frameIndex = 0;
     while (running) {
+	ZoneScoped;
+	ZoneName("GameLoop", sizeof("GameLoop"));
+
+        //Waits while the render thread still draws the frame before last, and
+        //through it on the pacer, so input isn't sampled with too many frames in flight
+        FramePacket& packet = *(FramePacket*)AcquirePacket(renderThread);
+        ResetArena(packet.arena); // The render thread is done with last time's data
+        frameStats.render = packet.results;
+        frameStats.thread = GetRenderThreadStats(renderThread);
+        packet.sampled = SDL_GetPerformanceCounter();
 
         //*****************POLL EVENTS********************
-        SDL_Event ev;
-        while (SDL_PollEvent(&ev)) {
-            ImGui_ImplSDL3_ProcessEvent(&ev);
-
-            switch (ev.type) {
-                case SDL_EVENT_QUIT:
-                    running = false;
-                    break;
-                case SDL_EVENT_KEY_DOWN:
-                    if (!io.WantCaptureKeyboard) {
-                        if (ev.key.key == SDLK_ESCAPE) running = false;
-                    }
-                    break;
-                case SDL_EVENT_WINDOW_RESIZED:
-                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
-                    int w_px, h_px;
-                    SDL_GetWindowSizeInPixels(gl.window, &w_px, &h_px);
-                    glViewport(0, 0, w_px, h_px);
-                    break;
-                default:
-                    break;
+        {
+            AllocZoneScopedN("Events");
+            SDL_Event ev;
+            while (SDL_PollEvent(&ev)) {
+                ImGui_ImplSDL3_ProcessEvent(&ev);
+
+                switch (ev.type) {
+                    case SDL_EVENT_QUIT:
+                        running = false;
+                        break;
+                    case SDL_EVENT_KEY_DOWN:
+                        if (!io.WantCaptureKeyboard) {
+                            if (ev.key.key == SDLK_ESCAPE) running = false;
+                        }
+                        break;
+                    default:
+                        break;
+                }
             }
         }
         //**********************GAME LOOP************************
         //Imgui config
-	ZoneScoped;
-	ZoneName("GameLoop", sizeof("Gameloop"));
-        ConfigImgui(io, triangleColor, clearColor);
-
+        {
+            AllocZoneScopedN("UI");
+            ConfigImgui(io, settings, frameStats, pacer, simClock);
+            // ImGui's first save would come a few seconds in; done now, in the
+            // warm up, its settings and text buffer are already there by then
+            if (frameIndex == 1 && io.IniFilename) ImGui::SaveIniSettingsToDisk(io.IniFilename);
+        }
+        SceneState renderState;
+        {
+            AllocZoneScopedN("Simulate");
+            uint64_t now = options.headless ? (frameIndex + 1) * simClock.stepNs : SDL_GetTicksNS();
+            int steps = AdvanceSimClock(simClock, now);
+            for (int i = 0; i < steps; i++) {
+                previousState = currentState;
+                StepScene(currentState, SimStepSeconds(simClock));
+            }
+            renderState = settings.interpolate ? LerpScene(previousState, currentState, simClock.alpha)
+                                               : currentState;
+        }
 
         auto t1 = std::chrono::high_resolution_clock::now();
-        float s = std::chrono::duration<float>(t1 - t0).count();
-
-        glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y); // Use ImGui display size
-        glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(program);
-        GLint angleLoc = glGetUniformLocation(program, "uAngle");
-        glUniform1f(angleLoc, s); // Update rotation angle
-
-        GLint colorLoc = glGetUniformLocation(program, "uColor");
-        glUniform4fv(colorLoc, 1, glm::value_ptr(triangleColor));
-
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glBindVertexArray(0); // Unbind VAO
+        PushFrameTime(frameTimes, std::chrono::duration<double, std::milli>(t1 - tFrame).count());
+        tFrame = t1;
+
+        //Hand the frame over; the render thread draws it while the next one is built
+        packet.frame = frameIndex;
+        SDL_GetWindowSizeInPixels(gl.window, &packet.width, &packet.height);
+        packet.settings = settings;
+        packet.spin = (float)renderState.spin;
+        {
+            AllocZoneScopedN("Animate Grid");
+            packet.shapeCount = (uint32_t)std::max(settings.shapeCount, 0);
+            packet.shapes = AnimateGrid(jobs, packet.arena, packet.spin, packet.shapeCount);
+        }
+        TakeDrawData(packet);
+        SubmitPacket(renderThread);
+
+        frameStats.frameTimes = SummarizeFrameTimes(frameTimes);
+        {
+            // Always the full graph, so ImGui's vertex buffers stop growing after the first frame
+            float* recent = frameStats.recentFrames;
+            size_t count = CopyFrameTimes(frameTimes, recent, kFrameTimeGraph);
+            std::copy_backward(recent, recent + count, recent + kFrameTimeGraph);
+            std::fill(recent, recent + kFrameTimeGraph - count, 0.0f);
+        }
+        EndAllocFrame();
+        FrameMark;
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        SDL_GL_SwapWindow(gl.window);
+        if (options.frames > 0 && ++frameIndex >= options.frames) running = false;
+    }
+    StopRenderThread(renderThread);
+    CleanupJobSystem(jobs);
+
+    if (options.frames > 0) {
+        PrintFrameTimes(SummarizeFrameTimes(frameTimes));
+        std::cout << "GPU frame: " << GpuFrameMs(renderer.gpuProfiler) << " ms (last resolved)\n";
+        PrintPacingStats(pacer);
+        RenderThreadStats threadStats = GetRenderThreadStats(renderThread);
+        std::cout << "Render thread: " << threadStats.frames << " frames, main waited " << threadStats.mainWaits
+                  << " times (" << threadStats.mainWaitMs << " ms), render idle " << threadStats.renderWaits
+                  << " times\n";
+        PrintJobSystemStats(jobs);
+        for (const FramePacket& p : packets) PrintArenaStats(p.arena);
+        PrintAllocStats();
+        PrintGeometryPoolStats(renderer.instances.geometry);
+        PrintVertexFormatStats();
+        PrintGLResourceStats();
     }
 
     //**********************CLEANUP PROGRAM******************
+    for (FramePacket& p : packets) {
+        FreeDrawLists(p);
+        CleanupArena(p.arena);
+    }
     //Cleanup IMGUI
     CleanupImgui();
 
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo);
-    glDeleteProgram(program);
+    CleanupFramePacer(pacer);
+    CleanupBatchRenderer(renderer.batch);
+    CleanupInstanceRenderer(renderer.instances);
+    CleanupGpuProfiler(renderer.gpuProfiler);
+    CleanupRenderTarget(renderer.renderTarget);
+    CleanupShaderManager(shaders);
+    CleanupVertexFormats();
+    CleanupGLResources();
 
     //Cleanup SDL
     CleanupSDL(gl);
@@ -173,163 +403,418 @@ int main(int argc, char** argv) {
     return 0;
 }
 //****************FUNCTION IMPLEMENTATIONS*************************
-static GLuint LinkProgram(GLuint vs, GLuint fs) 
-{
-    GLuint p = glCreateProgram();
-    glAttachShader(p, vs);
-    glAttachShader(p, fs);
-    glLinkProgram(p);
-    GLint ok = 0;
-    glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        GLint logLength = 0;
-        glGetProgramiv(p, GL_INFO_LOG_LENGTH, &logLength);
-        std::vector<char> buf(logLength);
-        glGetProgramInfoLog(p, logLength, nullptr, buf.data());
-        std::cerr << "Program link error: " << buf.data() << "\n";
-        glDeleteProgram(p);
-        std::exit(-1);
+AppOptions ParseOptions(int argc, char** argv) {
+    AppOptions options;
+
+    // DEMATIK_HEADLESS=<frames> turns headless mode on without touching the command line
+    if (const char* env = std::getenv("DEMATIK_HEADLESS")) {
+        options.headless = true;
+        options.frames = std::atoi(env);
     }
-    glDetachShader(p, vs);
-    glDetachShader(p, fs);
-    return p;
+    bool pacingGiven = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--shapes" && i + 1 < argc) {
+            options.shapes = std::atoi(argv[++i]);
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            pacingGiven = ParsePacingMode(argv[++i], options.pacing);
+            if (!pacingGiven) std::cerr << "Unknown pacing mode '" << argv[i] << "'\n";
+        } else if (arg == "--fps" && i + 1 < argc) {
+            options.fps = std::atof(argv[++i]);
+        } else if (arg == "--max-in-flight" && i + 1 < argc) {
+            options.maxInFlight = std::atoi(argv[++i]);
+        } else if (arg == "--tick-rate" && i + 1 < argc) {
+            options.tickRate = std::max(1.0, std::atof(argv[++i]));
+        } else if (arg == "--single-thread") {
+            options.renderThread = false;
+        } else if (arg == "--render-thread") {
+            if (!kRenderThreadSupported) std::cerr << "GL off the main thread is unsupported here, rendering anyway\n";
+            options.renderThread = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.workers = std::atoi(argv[++i]);
+        } else if (arg == "--alloc-check") {
+            options.allocCheck = true;
+        } else if (arg == "--pin") {
+            options.pinWorkers = true;
+        } else {
+            std::cerr << "Ignoring unknown argument '" << arg << "'\n";
+        }
+    }
+    if (options.headless && options.frames <= 0) options.frames = 1000;
+    if (options.headless && !pacingGiven) options.pacing = PacingMode::Uncapped;
+    return options;
 }
+void ConfigImgui(ImGuiIO& io, AppSettings& settings, const FrameStats& stats, const FramePacer& pacer,
+                 SimClock& simClock) {
 
-std::string LoadShaderSource(const char* filepath) 
-{
-    std::ifstream file(filepath);
-    if(!file) {
-        std::cerr << "Failed to open shader file: " << filepath << "\n";
-        std::exit(-1);
-    }
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplSDL3_NewFrame();
+    ImGui::NewFrame();
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
-static GLuint CompileShader(GLenum type, const char* src) 
-{
-    GLuint s = glCreateShader(type);
-    glShaderSource(s, 1, &src, nullptr);
-    glCompileShader(s);
-    GLint ok = 0;
-    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        GLint logLength = 0;
-        glGetShaderiv(s, GL_INFO_LOG_LENGTH, &logLength);
-        std::vector<char> buf(logLength);
-        glGetShaderInfoLog(s, logLength, nullptr, buf.data());
-        std::cerr << "Shader compile error: " << buf.data() << "\n";
-        glDeleteShader(s);
-        std::exit(-1);
-    }
-    return s;
+    const RenderResults& render = stats.render;
+    ImGui::Begin("Settings");
+    ImGui::ColorEdit4("Clear Color", glm::value_ptr(settings.clearColor));
+    ImGui::ColorEdit4("Triangle Color",
+                      glm::value_ptr(settings.triangleColor));
+    ImGui::SliderInt("Shape Count", &settings.shapeCount, 0, 100000);
+    ImGui::Checkbox("Instanced Shapes", &settings.instanced);
+    ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
+                1000.0f / io.Framerate, io.Framerate);
+    DrawFrameTimes(stats);
+    DrawFramePacing(settings, stats, pacer);
+    DrawSimulation(simClock, settings.interpolate);
+    ImGui::Text("Batch: %u shapes, %u draw calls, %u vertices",
+                render.batch.shapes, render.batch.drawCalls, render.batch.vertices);
+    ImGui::Text("Instanced: %u instances, %u meshes in %u draw calls",
+                render.instances.instances, render.instances.meshDraws, render.instances.drawCalls);
+    ImGui::Text("Draw queue: %u draws, %u program switches, sort %.3f ms, %u early executes",
+                render.queue.submitted, render.queue.programSwitches, render.queue.sortMs,
+                render.batch.queueSplits);
+    ImGui::Text("GL state: %u calls issued, %u elided",
+                render.glState.issued, render.glState.elided);
+    ImGui::Text("Uploaded: %.1f KB", render.uploadBytes / 1024.0);
+    ImGui::Text("Render thread: main waited %llu times (%.1f ms total), render idle %llu times",
+                (unsigned long long)stats.thread.mainWaits, stats.thread.mainWaitMs,
+                (unsigned long long)stats.thread.renderWaits);
+    DrawGpuProfile(render);
+    ImGui::End();
+
+    ImGui::Render();
+
+    return;
 }
-void SetGLAttributes() {
+void StepScene(SceneState& state, double dt){
 
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+    const double kSpinSpeed = 1.0; // Radians per second
+    state.spin = std::fmod(state.spin + kSpinSpeed * dt, glm::two_pi<double>());
 }
-void InitSDL(){
-    if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
-        return;
-    }
+SceneState LerpScene(const SceneState& previous, const SceneState& current, double alpha){
+
+    // Angles wrap, so go the short way round
+    double delta = current.spin - previous.spin;
+    if (delta > glm::pi<double>()) delta -= glm::two_pi<double>();
+    if (delta < -glm::pi<double>()) delta += glm::two_pi<double>();
+    SceneState state;
+    state.spin = previous.spin + delta * alpha;
+    return state;
 }
-GLContext InitSDLGL(const char* title, int width, int height) {
-    GLContext gl;
-
-    gl.window = SDL_CreateWindow(
-        title, width, height,
-        SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE
-    );
+struct GridJob {
+    InstanceData* shapes;
+    float spin;
+    int side;
+};
 
-    if (!gl.window) {
-	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateWindow failed: %s", SDL_GetError());
-        SDL_Quit();
-        std::exit(-1);
+static void AnimateGridRange(void* data, uint32_t begin, uint32_t end){
+
+    const GridJob& job = *(const GridJob*)data;
+    float cell = 2.0f / job.side;
+    for (uint32_t i = begin; i < end; i++) {
+        int x = (int)i % job.side;
+        int y = (int)i / job.side;
+        InstanceData& shape = job.shapes[i];
+        glm::vec2 center(-1.0f + (x + 0.5f) * cell, -1.0f + (y + 0.5f) * cell);
+        shape.color = glm::vec4((float)x / job.side, (float)y / job.side, 0.5f, 1.0f);
+        if (i & 1) {
+            shape.transform = glm::vec4(center, glm::vec2(cell * 0.35f));
+            shape.angle = 0.0f;
+        } else {
+            shape.transform = glm::vec4(center, glm::vec2(cell * 0.7f));
+            shape.angle = job.spin + i * 0.01f;
+        }
     }
-
-    gl.context = SDL_GL_CreateContext(gl.window);
-    if (!gl.context) {
-	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_GL_CreateContext failed: %s", SDL_GetError());
-        SDL_DestroyWindow(gl.window);
-        SDL_Quit();
-        std::exit(-1);
+}
+InstanceData* AnimateGrid(JobSystem& jobs, LinearArena& arena, float spin, uint32_t shapeCount){
+
+    // Background grid of spinning shapes, alternating quads and circles.
+    // Independent per shape, so it's split across the job system.
+    if (shapeCount == 0) return nullptr;
+    InstanceData* shapes = ArenaAllocArray<InstanceData>(arena, shapeCount);
+    GridJob job{shapes, spin, (int)std::ceil(std::sqrt((float)shapeCount))};
+    ParallelFor(jobs, shapeCount, 1024, AnimateGridRange, &job);
+    return shapes;
+}
+void SubmitScene(BatchRenderer& batch, const InstancedScene& scene, const InstanceData* shapes,
+                 uint32_t shapeCount, float spin, glm::vec4 triangleColor){
+
+    for (uint32_t i = 0; i < shapeCount; i++) {
+        const InstanceData& shape = shapes[i];
+        if (scene.renderer) {
+            InstancePush(*scene.renderer, i & 1 ? scene.circleMesh : scene.rectMesh, shape);
+        } else if (i & 1) {
+            BatchPushCircle(batch, glm::vec2(shape.transform), shape.transform.z, shape.color, 8);
+        } else {
+            BatchPushRect(batch, glm::vec2(shape.transform), glm::vec2(shape.transform.z, shape.transform.w),
+                          shape.angle, shape.color);
+        }
     }
 
-    SDL_GL_MakeCurrent(gl.window, gl.context);
-    SDL_GL_SetSwapInterval(1);
+    // The rotating triangle, transformed on the CPU
+    float c = std::cos(spin);
+    float sn = std::sin(spin);
+    glm::mat2 rot(c, -sn, sn, c); // Same layout the old vertex shader used
+    BatchPushTriangle(batch,
+                      rot * glm::vec2(0.0f, 0.5f),   // Top
+                      rot * glm::vec2(-0.5f, -0.5f), // Left
+                      rot * glm::vec2(0.5f, -0.5f),  // Right
+                      triangleColor);
+}
+uint64_t StreamedBytes(const BatchRenderer& batch, const InstanceRenderer& instances){
+    uint64_t bytes = batch.vertexStream.stats.bytesAllocated + batch.indexStream.stats.bytesAllocated +
+                     instances.instanceStream.stats.bytesAllocated;
+    if (instances.indirect) bytes += instances.commandStream.stats.bytesAllocated;
+    return bytes;
+}
+void DrawGpuProfile(const RenderResults& results){
 
-    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-	SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to init GlAD: %s", SDL_GetError());
-        SDL_GL_DestroyContext(gl.context);
-        SDL_DestroyWindow(gl.window);
-        SDL_Quit();
-        std::exit(-1);
+    if (!ImGui::CollapsingHeader("GPU Profiler", ImGuiTreeNodeFlags_DefaultOpen)) return;
+    if (!results.gpuEnabled) {
+        ImGui::TextDisabled("Timer queries unavailable");
+        return;
     }
 
-    return gl;
+    double frameMs = results.gpuTimings.empty() ? 0.0 : results.gpuTimings[0].ms;
+    char overlay[32];
+    std::snprintf(overlay, sizeof(overlay), "%.3f ms", frameMs);
+    ImGui::PlotLines("GPU Frame", results.gpuHistory, kGpuProfilerHistory, results.gpuHistoryHead,
+                     overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+    // One row per pass, indented under its parent, with its share of the frame
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+    if (ImGui::BeginTable("GPU Passes", 4, flags)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("avg ms", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("Frame %");
+        ImGui::TableHeadersRow();
+        for (const GpuTiming& t : results.gpuTimings) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%*s%s", t.depth * 2, "", t.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", t.ms);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.3f", t.avgMs);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::ProgressBar(frameMs > 0.0 ? (float)(t.ms / frameMs) : 0.0f, ImVec2(-FLT_MAX, 0.0f), "");
+        }
+        ImGui::EndTable();
+    }
+    if (results.gpuDropped) ImGui::TextDisabled("%u frames dropped waiting on results", results.gpuDropped);
 }
-void PrintGLInfo(){
-
-    std::cout << "OpenGL Vendor: " << glGetString(GL_VENDOR) << "\n";
-    std::cout << "OpenGL Renderer: " << glGetString(GL_RENDERER) << "\n";
-    std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << "\n";
-    std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION)
-              << "\n";
+void DrawFrameTimes(const FrameStats& stats){
+
+    if (!ImGui::CollapsingHeader("Frame Times", ImGuiTreeNodeFlags_DefaultOpen)) return;
+    const FrameTimeSummary& ft = stats.frameTimes;
+    ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms (last %u frames)",
+                ft.p50Ms, ft.p95Ms, ft.p99Ms, ft.maxMs, ft.frames);
+    ImGui::Text("Over %.2f ms budget: %u recent, %llu total",
+                ft.budgetMs, ft.overBudget, (unsigned long long)ft.overBudgetTotal);
+
+    char overlay[32];
+    std::snprintf(overlay, sizeof(overlay), "avg %.2f ms", ft.avgMs);
+    ImGui::PlotLines("Frame Time", stats.recentFrames, kFrameTimeGraph, 0, overlay,
+                     0.0f, (float)(ft.budgetMs * 2.0), ImVec2(0.0f, 60.0f));
+
+    float histogram[kFrameTimeBuckets];
+    for (int i = 0; i < kFrameTimeBuckets; i++) histogram[i] = (float)ft.histogram[i];
+    std::snprintf(overlay, sizeof(overlay), "%.2f ms buckets", ft.bucketMs);
+    ImGui::PlotHistogram("Histogram", histogram, kFrameTimeBuckets, 0, overlay,
+                         0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
 }
-ImGuiIO& InitIMGUI(GLContext gl){
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    (void)io;
-
-    ImGui::StyleColorsDark();
-    ImGuiStyle& style = ImGui::GetStyle();
-
-    const char* glsl_version = "#version 330 core"; // Match shader version
-    ImGui_ImplSDL3_InitForOpenGL(gl.window, gl.context);
-    ImGui_ImplOpenGL3_Init(glsl_version);
-
-    return io;
+void DrawFramePacing(AppSettings& settings, const FrameStats& stats, const FramePacer& pacer){
+
+    if (!ImGui::CollapsingHeader("Frame Pacing", ImGuiTreeNodeFlags_DefaultOpen)) return;
+    // Settings go to the render thread with the next packet, stats come back two frames later
+    const RenderResults& render = stats.render;
+    int mode = (int)settings.pacing;
+    const char* modes[kPacingModes];
+    for (int i = 0; i < kPacingModes; i++) modes[i] = PacingModeName((PacingMode)i);
+    if (ImGui::Combo("Mode", &mode, modes, kPacingModes)) settings.pacing = (PacingMode)mode;
+    if (!render.adaptiveSupported) ImGui::TextDisabled("Adaptive vsync unsupported, falls back to vsync");
+    if (settings.pacing == PacingMode::Limited) {
+        float fps = (float)settings.targetFps;
+        if (ImGui::SliderFloat("Target FPS", &fps, 10.0f, 500.0f, "%.0f")) settings.targetFps = fps;
+    }
+    ImGui::SliderInt("Max Frames In Flight", &settings.maxFramesInFlight, 0, kFramePacerMaxFences);
+    ImGui::Text("Latency %.2f ms, %llu cap waits", render.latencyMs, (unsigned long long)render.capWaits);
+
+    // Input sampling to GPU done, for every mode that has run
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+    if (ImGui::BeginTable("Latency", 5, flags)) {
+        ImGui::TableSetupColumn("Mode");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("frames");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < kPacingModes; i++) {
+            FrameTimeSummary s = SummarizeFrameTimes(pacer.latency[i]);
+            if (s.frames == 0) continue;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(PacingModeName((PacingMode)i));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", s.p50Ms);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", s.p95Ms);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.2f", s.p99Ms);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%u", s.frames);
+        }
+        ImGui::EndTable();
+    }
 }
-void CleanupImgui(){
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplSDL3_Shutdown();
-    ImGui::DestroyContext();
-    return;
+void DrawSimulation(SimClock& simClock, bool& interpolate){
+
+    if (!ImGui::CollapsingHeader("Simulation", ImGuiTreeNodeFlags_DefaultOpen)) return;
+    // Below the display rate, interpolation is what keeps motion smooth
+    float tickRate = (float)SimTickRate(simClock);
+    if (ImGui::SliderFloat("Tick Rate", &tickRate, 5.0f, 240.0f, "%.0f Hz")) SetSimTickRate(simClock, tickRate);
+    ImGui::Checkbox("Interpolate", &interpolate);
+    ImGui::Text("Tick %llu, %.3f s, alpha %.2f, %.1f ms dropped",
+                (unsigned long long)simClock.tick, SimSeconds(simClock), simClock.alpha,
+                simClock.droppedNs / 1e6);
 }
-
-void CleanupSDL(GLContext gl){
-
-    SDL_GL_DestroyContext(gl.context);
-    SDL_DestroyWindow(gl.window);
-    SDL_Quit();
-
-    return;
+// Keeps an eighth over size free, so the next frames' few extra glyphs
+// don't regrow it, and reserves half again when there's less.
+template <typename T>
+static void ReserveHeadroom(ImVector<T>& buffer, int size) {
+    if (buffer.Capacity < size + size / 8) buffer.reserve(size + size / 2);
 }
-void ConfigImgui(ImGuiIO& io,glm::vec4 shapeColor,glm::vec4 clearColor) {
-
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplSDL3_NewFrame();
-    ImGui::NewFrame();
+void TakeDrawData(FramePacket& packet){
+
+    // ImGui's lists are swapped, not copied: the packet gets this frame's
+    // buffers and ImGui gets the packet's old ones, which it clears at the
+    // next NewFrame. Capacity moves back and forth, so nothing allocates.
+    // The three sets of buffers each get headroom over this frame's size,
+    // so they all stop growing in the warm up.
+    ImDrawData* src = ImGui::GetDrawData();
+    ImDrawData& dst = packet.drawData;
+    dst.Clear();
+    while (packet.drawLists.Size < src->CmdListsCount) {
+        packet.drawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+    }
+    for (int i = 0; i < src->CmdListsCount; i++) {
+        ImDrawList* from = src->CmdLists[i];
+        ImDrawList* to = packet.drawLists[i];
+        to->CmdBuffer.swap(from->CmdBuffer);
+        to->IdxBuffer.swap(from->IdxBuffer);
+        to->VtxBuffer.swap(from->VtxBuffer);
+        to->Flags = from->Flags;
+        ReserveHeadroom(from->CmdBuffer, to->CmdBuffer.Size);
+        ReserveHeadroom(from->IdxBuffer, to->IdxBuffer.Size);
+        ReserveHeadroom(from->VtxBuffer, to->VtxBuffer.Size);
+        dst.CmdLists.push_back(to);
+    }
+    dst.Valid = src->Valid;
+    dst.CmdListsCount = src->CmdListsCount;
+    dst.TotalIdxCount = src->TotalIdxCount;
+    dst.TotalVtxCount = src->TotalVtxCount;
+    dst.DisplayPos = src->DisplayPos;
+    dst.DisplaySize = src->DisplaySize;
+    dst.FramebufferScale = src->FramebufferScale;
+}
+void FreeDrawLists(FramePacket& packet){
 
-    ImGui::Begin("Settings");
-    ImGui::ColorEdit4("Clear Color", glm::value_ptr(clearColor));
-    ImGui::ColorEdit4("Triangle Color",
-                      glm::value_ptr(shapeColor));
-    ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
-                1000.0f / io.Framerate, io.Framerate);
-    ImGui::End();
+    packet.drawData.Clear();
+    for (ImDrawList* list : packet.drawLists) IM_DELETE(list);
+    packet.drawLists.clear();
+}
+void RenderFrame(void* user, void* data){
 
-    ImGui::Render();
+    AllocZoneScopedN("Render");
+    Renderer& r = *(Renderer*)user;
+    FramePacket& packet = *(FramePacket*)data;
+    const AppSettings& settings = packet.settings;
 
-    return;
-}
-void SetupTriangle(){
+    if (settings.pacing != r.requestedPacing) {
+        SetPacingMode(r.pacer, settings.pacing);
+        r.requestedPacing = settings.pacing;
+    }
+    r.pacer.targetFps = settings.targetFps;
+    r.pacer.maxFramesInFlight = settings.maxFramesInFlight;
+    UpdateShaderManager(r.shaders); // Swap in edited shaders
+
+    BeginGpuFrame(r.gpuProfiler);
+    {
+        AllocZoneScopedN("Scene");
+        TracyGpuZone("Scene");
+        GpuScope sceneScope(r.gpuProfiler, "Scene");
+        if (r.headless) {
+            BindRenderTarget(r.renderTarget);
+        } else {
+            StateBindFramebuffer(GL_FRAMEBUFFER, 0);
+            StateViewport(0, 0, packet.width, packet.height);
+        }
+        {
+            GpuScope clearScope(r.gpuProfiler, "Clear");
+            glClearColor(settings.clearColor.x, settings.clearColor.y, settings.clearColor.z, settings.clearColor.w);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
 
+        // Instanced draws go out right away, the batch's queued ones land on top
+        r.instancedScene.renderer = settings.instanced ? &r.instances : nullptr;
+        InstanceBegin(r.instances);
+        BatchBegin(r.batch);
+        SubmitScene(r.batch, r.instancedScene, packet.shapes, packet.shapeCount, packet.spin,
+                    settings.triangleColor);
+        {
+            GpuScope instancedScope(r.gpuProfiler, "Instanced");
+            InstanceEnd(r.instances);
+        }
+        BatchEnd(r.batch);
+        {
+            GpuScope batchScope(r.gpuProfiler, "Batch");
+            ExecuteDrawQueue(r.drawQueue);
+        }
+        BatchFenceFrame(r.batch);
+    }
+    {
+        AllocZoneScopedN("ImGui Render");
+        TracyGpuZone("ImGui");
+        GpuScope imguiScope(r.gpuProfiler, "ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(&packet.drawData);
+    }
+    EndGpuFrame(r.gpuProfiler);
+    {
+        AllocZoneScopedN("Present");
+        if (r.headless) {
+            glFlush(); // Nothing to present, just keep the GPU fed
+        } else {
+            SDL_GL_SwapWindow(r.gl.window);
+        }
+        PacerEndFrame(r.pacer, packet.sampled);
+        EndGLResourceFrame(); // Deletes objects whose last frame is done
+        TracyGpuCollect;
+    }
+    // Returning hands the packet back to the main thread, which samples input
+    // right after, so the pacer waits here; a packet queued behind this one
+    // counts as in flight
+    PacerBeginFrame(r.pacer, r.packetsQueued);
+
+    RenderResults& results = packet.results;
+    results.batch = r.batch.stats;
+    results.instances = r.instances.stats;
+    results.queue = r.drawQueue.stats;
+    results.glState = GetGLStateCounters();
+    ResetGLStateCounters();
+    uint64_t streamed = StreamedBytes(r.batch, r.instances);
+    results.uploadBytes = streamed - r.streamedBytes;
+    r.streamedBytes = streamed;
+    results.gpuEnabled = r.gpuProfiler.enabled;
+    results.gpuTimings = r.gpuProfiler.timings;
+    std::copy(r.gpuProfiler.history, r.gpuProfiler.history + kGpuProfilerHistory, results.gpuHistory);
+    results.gpuHistoryHead = r.gpuProfiler.historyHead;
+    results.gpuDropped = r.gpuProfiler.dropped;
+    results.pacing = r.pacer.mode;
+    results.adaptiveSupported = r.pacer.adaptiveSupported;
+    results.latencyMs = r.pacer.lastLatencyMs;
+    results.capWaits = r.pacer.capWaits;
+    TracyPlot("Draw calls", (int64_t)(results.batch.drawCalls + results.instances.drawCalls));
+    TracyPlot("Uploaded bytes", (int64_t)results.uploadBytes);
 }
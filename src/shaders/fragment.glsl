@@ -1,6 +1,6 @@
 #version 330 core
+in vec4 vColor;
 out vec4 FragColor;
-uniform vec4 uColor; // Added color uniform
 void main() {
-    FragColor = uColor; // Use the uniform
+    FragColor = vColor;
 }
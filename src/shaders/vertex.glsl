@@ -1,10 +1,38 @@
 #version 330 core
 layout(location = 0) in vec2 aPos;
-uniform float uAngle;
+layout(location = 1) in vec4 aColor;
+#ifdef INSTANCED
+#ifdef INDIRECT
+// Instances of every mesh in a multi-draw, 9 floats each (InstanceData).
+// iIndex is baseInstance + gl_InstanceID, from a divisor 1 stream.
+layout(location = 5) in uint iIndex;
+layout(std430, binding = 0) readonly buffer Instances {
+    float iData[];
+};
+#else
+layout(location = 2) in vec4 iTransform; // xy offset, zw scale
+layout(location = 3) in vec4 iColor;
+layout(location = 4) in float iAngle;
+#endif
+#endif
+uniform mat4 uViewProj;
+out vec4 vColor;
 void main() {
-    mat2 rot = mat2(
-        cos(uAngle), -sin(uAngle),
-        sin(uAngle),  cos(uAngle)
-    );
-    gl_Position = vec4(rot * aPos, 0.0, 1.0);
+#ifdef INSTANCED
+#ifdef INDIRECT
+    int i = int(iIndex) * 9;
+    vec4 iTransform = vec4(iData[i], iData[i + 1], iData[i + 2], iData[i + 3]);
+    vec4 iColor = vec4(iData[i + 4], iData[i + 5], iData[i + 6], iData[i + 7]);
+    float iAngle = iData[i + 8];
+#endif
+    float c = cos(iAngle);
+    float s = sin(iAngle);
+    vec2 p = aPos * iTransform.zw;
+    p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + iTransform.xy;
+    vColor = aColor * iColor;
+#else
+    vec2 p = aPos;
+    vColor = aColor;
+#endif
+    gl_Position = uViewProj * vec4(p, 0.0, 1.0);
 }
@@ -0,0 +1,205 @@
+// tests/JobSystemTsanTest.cpp
+
+#include "JobSystem.h"
+
+#include <iostream>
+#include <vector>
+
+/*
+* Stress for the job system, meant to run under ThreadSanitizer: ParallelFor,
+* many small jobs pushed by one thread and stolen by the rest, jobs that push
+* and wait on their own jobs from the workers, dependency chains through
+* RunJobsAfter, and an attached thread submitting alongside the main one.
+*
+* Jobs write plain memory that the waiting thread reads back, so a missing
+* barrier in the deques or counters shows up as a race report as well as a
+* wrong value. SDL's atomics have to be built with the sanitizer too, or it
+* can't see them order anything.
+*/
+static const int kRounds = 100;
+static const int kWorkers = 3;
+
+static SDL_AtomicInt failures; // Also counted by the attached thread
+
+static void Fail(const char* test, int round) {
+    if (SDL_AddAtomicInt(&failures, 1) < 10) std::cerr << test << " failed in round " << round << "\n";
+}
+
+static void AddOne(void* data, uint32_t begin, uint32_t end) {
+    int* items = (int*)data;
+    for (uint32_t i = begin; i < end; i++) items[i]++;
+}
+
+static void TestParallelFor(JobSystem& js, int round) {
+    std::vector<int> items(5000 + round * 37, 0);
+    ParallelFor(js, (uint32_t)items.size(), 64, AddOne, items.data());
+    ParallelFor(js, (uint32_t)items.size(), 1, AddOne, items.data());
+    for (int item : items) {
+        if (item != 2) return Fail("ParallelFor", round);
+    }
+}
+
+struct Tally {
+    SDL_AtomicInt count{};
+    int* slots = nullptr;
+};
+
+static void Mark(void* data, uint32_t begin, uint32_t) {
+    Tally* tally = (Tally*)data;
+    tally->slots[begin] = (int)begin + 1;
+    SDL_AddAtomicInt(&tally->count, 1);
+}
+
+// One job per item, all pushed before waiting, so the workers steal most.
+static void TestPushSteal(JobSystem& js, int round) {
+    const int count = kJobPoolSize / 2;
+    std::vector<int> slots(count, 0);
+    Tally tally;
+    tally.slots = slots.data();
+    std::vector<Job> jobs(count);
+    for (int i = 0; i < count; i++) {
+        jobs[i].fn = Mark;
+        jobs[i].data = &tally;
+        jobs[i].begin = (uint32_t)i;
+        jobs[i].end = (uint32_t)i + 1;
+    }
+    JobCounter counter;
+    InitJobCounter(counter);
+    RunJobs(js, jobs.data(), jobs.size(), &counter);
+    WaitForCounter(js, counter);
+    if (SDL_GetAtomicInt(&tally.count) != count) return Fail("Push and steal count", round);
+    for (int i = 0; i < count; i++) {
+        if (slots[i] != i + 1) return Fail("Push and steal", round);
+    }
+}
+
+struct Nested {
+    JobSystem* js = nullptr;
+    int* items = nullptr;
+};
+
+static const int kNestedJobs = 8;
+static const int kNestedItems = 64; // Per nested job, one sub job each; all of them fit one job pool
+
+// Pushes to the deque of whichever thread runs it and waits there.
+static void RunNested(void* data, uint32_t begin, uint32_t) {
+    Nested* nested = (Nested*)data;
+    int* items = nested->items + begin * kNestedItems;
+    Job jobs[kNestedItems];
+    for (int i = 0; i < kNestedItems; i++) {
+        jobs[i].fn = AddOne;
+        jobs[i].data = items;
+        jobs[i].begin = (uint32_t)i;
+        jobs[i].end = (uint32_t)i + 1;
+    }
+    JobCounter counter;
+    InitJobCounter(counter);
+    RunJobs(*nested->js, jobs, kNestedItems, &counter);
+    WaitForCounter(*nested->js, counter);
+    for (int i = 0; i < kNestedItems; i++) items[i] *= 3;
+}
+
+static void TestNested(JobSystem& js, int round) {
+    std::vector<int> items(kNestedJobs * kNestedItems, 0);
+    Nested nested{&js, items.data()};
+    Job jobs[kNestedJobs];
+    for (int i = 0; i < kNestedJobs; i++) {
+        jobs[i].fn = RunNested;
+        jobs[i].data = &nested;
+        jobs[i].begin = (uint32_t)i;
+        jobs[i].end = (uint32_t)i + 1;
+    }
+    JobCounter counter;
+    InitJobCounter(counter);
+    RunJobs(js, jobs, kNestedJobs, &counter);
+    WaitForCounter(js, counter);
+    for (int item : items) {
+        if (item != 3) return Fail("Nested", round);
+    }
+}
+
+struct Stage {
+    int* items = nullptr;
+    int add = 0;
+};
+
+static void RunStage(void* data, uint32_t begin, uint32_t end) {
+    Stage* stage = (Stage*)data;
+    for (uint32_t i = begin; i < end; i++) stage->items[i] = stage->items[i] * 2 + stage->add;
+}
+
+// first -> second -> third, each over all items; any overlap changes the result.
+static void TestChain(JobSystem& js, int round) {
+    const int batches = 16;
+    const int batch = 256;
+    std::vector<int> items(batches * batch, 1);
+    Stage stages[3] = {{items.data(), 1}, {items.data(), 3}, {items.data(), 5}};
+    Job jobs[3][batches];
+    for (int s = 0; s < 3; s++) {
+        for (int i = 0; i < batches; i++) {
+            jobs[s][i].fn = RunStage;
+            jobs[s][i].data = &stages[s];
+            jobs[s][i].begin = (uint32_t)(i * batch);
+            jobs[s][i].end = (uint32_t)((i + 1) * batch);
+        }
+    }
+    JobCounter counters[3];
+    for (JobCounter& counter : counters) InitJobCounter(counter);
+    RunJobs(js, jobs[0], batches, &counters[0]);
+    RunJobsAfter(js, counters[0], jobs[1], batches, &counters[1]);
+    RunJobsAfter(js, counters[1], jobs[2], batches, &counters[2]);
+    WaitForCounter(js, counters[2]);
+    for (JobCounter& counter : counters) {
+        if (!JobCounterDone(counter)) return Fail("Chain counter", round);
+    }
+    // ((1 * 2 + 1) * 2 + 3) * 2 + 5
+    for (int item : items) {
+        if (item != 23) return Fail("Chain", round);
+    }
+}
+
+struct External {
+    JobSystem* js = nullptr;
+    bool attached = false;
+};
+
+static int RunExternal(void* data) {
+    External* external = (External*)data;
+    external->attached = AttachJobThread(*external->js);
+    for (int round = 0; round < kRounds; round++) {
+        TestParallelFor(*external->js, round);
+        TestChain(*external->js, round);
+    }
+    return 0;
+}
+
+int main() {
+    if (!SDL_Init(0)) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    JobSystem js;
+    InitJobSystem(js, kWorkers);
+
+    External external{&js};
+    SDL_Thread* thread = SDL_CreateThread(RunExternal, "external", &external);
+    for (int round = 0; round < kRounds; round++) {
+        TestParallelFor(js, round);
+        TestPushSteal(js, round);
+        TestNested(js, round);
+        TestChain(js, round);
+    }
+    SDL_WaitThread(thread, nullptr);
+    if (!external.attached) Fail("AttachJobThread", 0);
+
+    CleanupJobSystem(js);
+    PrintJobSystemStats(js);
+    if (js.totals.executed == 0 || js.totals.stolen > js.totals.executed) Fail("Stats", 0);
+    SDL_Quit();
+    if (int failed = SDL_GetAtomicInt(&failures)) {
+        std::cerr << failed << " JobSystem check(s) failed\n";
+        return 1;
+    }
+    std::cout << "JobSystem: all checks passed\n";
+    return 0;
+}
@@ -0,0 +1,154 @@
+// tests/RangeAllocatorTest.cpp
+
+#include "RangeAllocator.h"
+
+#include <iostream>
+
+/*
+* CPU-only checks of the offset allocator: size class boundaries, merging of
+* freed ranges with their neighbours, and the pack-or-grow decision the
+* geometry pool makes when an allocation fails. Exits non-zero on a failure.
+*/
+static int failures = 0;
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+static void Check(bool ok, const char* what, int line) {
+    if (ok) return;
+    std::cerr << "RangeAllocatorTest.cpp:" << line << ": failed: " << what << "\n";
+    failures++;
+}
+
+static void TestSizeBins() {
+    for (uint32_t size = 0; size < 8; size++) {
+        CHECK(RangeSizeBin(size, false) == size);
+        CHECK(RangeSizeBin(size, true) == size);
+    }
+    CHECK(RangeSizeBin(8, false) == 8);
+    CHECK(RangeSizeBin(15, false) == 15);
+    CHECK(RangeSizeBin(16, false) == 16);
+    CHECK(RangeSizeBin(16, true) == 16);
+    // 17 is between the classes of 16 and 18
+    CHECK(RangeSizeBin(17, false) == 16);
+    CHECK(RangeSizeBin(17, true) == 17);
+    CHECK(RangeSizeBin(18, false) == 17);
+    // Rounding up the last mantissa carries into the next power of two
+    CHECK(RangeSizeBin(31, false) == 23);
+    CHECK(RangeSizeBin(31, true) == RangeSizeBin(32, false));
+    CHECK(RangeSizeBin(0xFFFFFFFFu, true) < (uint32_t)kRangeBins);
+
+    // Everything filed at or above a request's rounded up class fits it
+    for (uint32_t request = 1; request < 600; request++) {
+        uint32_t bin = RangeSizeBin(request, true);
+        for (uint32_t size = 1; size < request; size++) {
+            if (RangeSizeBin(size, false) >= bin) {
+                CHECK(!"a smaller range is filed in the request's class");
+                return;
+            }
+        }
+    }
+}
+
+// Three 10 unit allocations filling the space exactly, so the only free
+// ranges are the ones the test frees.
+struct ThreeRanges {
+    RangeAllocator a;
+    RangeAllocation left, middle, right;
+};
+
+static void InitThreeRanges(ThreeRanges& t) {
+    InitRangeAllocator(t.a, 30);
+    t.left = RangeAlloc(t.a, 10);
+    t.middle = RangeAlloc(t.a, 10);
+    t.right = RangeAlloc(t.a, 10);
+}
+
+static void TestMerge() {
+    ThreeRanges t;
+    InitThreeRanges(t);
+    CHECK(t.right.node != kRangeNone && t.right.offset == 20);
+    CHECK(t.a.freeUnits == 0 && LargestFreeRange(t.a) == 0);
+    CHECK(RangeAlloc(t.a, 1).node == kRangeNone);
+
+    // Merged into the free range before it
+    RangeFree(t.a, t.left.node);
+    RangeFree(t.a, t.middle.node);
+    CHECK(LargestFreeRange(t.a) == 20);
+    RangeAllocation merged = RangeAlloc(t.a, 20);
+    CHECK(merged.node != kRangeNone && merged.offset == 0);
+
+    // Merged with the free range after it
+    InitThreeRanges(t);
+    RangeFree(t.a, t.right.node);
+    RangeFree(t.a, t.middle.node);
+    CHECK(LargestFreeRange(t.a) == 20);
+    merged = RangeAlloc(t.a, 20);
+    CHECK(merged.node != kRangeNone && merged.offset == 10);
+
+    // Both at once
+    InitThreeRanges(t);
+    RangeFree(t.a, t.left.node);
+    RangeFree(t.a, t.right.node);
+    CHECK(LargestFreeRange(t.a) == 10);
+    RangeFree(t.a, t.middle.node);
+    CHECK(t.a.freeUnits == 30 && t.a.allocations == 0);
+    CHECK(LargestFreeRange(t.a) == 30);
+    merged = RangeAlloc(t.a, 30);
+    CHECK(merged.node != kRangeNone && merged.offset == 0);
+}
+
+static void TestDoubleFree() {
+    ThreeRanges t;
+    InitThreeRanges(t);
+    RangeFree(t.a, t.left.node);
+    RangeFree(t.a, t.middle.node); // Absorbed into left
+    RangeFree(t.a, t.middle.node);
+    RangeFree(t.a, t.left.node);
+    CHECK(t.a.freeUnits == 20 && t.a.allocations == 1);
+    CHECK(LargestFreeRange(t.a) == 20);
+    RangeFree(t.a, kRangeNone);
+    CHECK(t.a.freeUnits == 20);
+}
+
+static void TestGrow() {
+    ThreeRanges t;
+    InitThreeRanges(t);
+    RangeFree(t.a, t.right.node);
+    GrowRangeAllocator(t.a, 50);
+    CHECK(t.a.capacity == 50 && t.a.freeUnits == 30);
+    CHECK(LargestFreeRange(t.a) == 30);
+    RangeAllocation grown = RangeAlloc(t.a, 30);
+    CHECK(grown.node != kRangeNone && grown.offset == 20);
+}
+
+static void TestPackThreshold() {
+    // Every other 10 unit range freed: 50 units free, no range over 10
+    RangeAllocator a;
+    InitRangeAllocator(a, 100);
+    RangeAllocation ranges[10];
+    for (RangeAllocation& r : ranges) r = RangeAlloc(a, 10);
+    for (int i = 0; i < 10; i += 2) RangeFree(a, ranges[i].node);
+    CHECK(a.freeUnits == 50 && LargestFreeRange(a) == 10);
+    CHECK(RangeAlloc(a, 11).node == kRangeNone);
+
+    // Packing pays while a quarter of the capacity stays free afterwards
+    CHECK(RangePackPays(a, 11));
+    CHECK(RangePackPays(a, 25));
+    CHECK(!RangePackPays(a, 26));
+    CHECK(!RangePackPays(a, 50));
+    CHECK(!RangePackPays(a, 60));
+}
+
+int main() {
+    TestSizeBins();
+    TestMerge();
+    TestDoubleFree();
+    TestGrow();
+    TestPackThreshold();
+    if (failures) {
+        std::cerr << failures << " RangeAllocator check(s) failed\n";
+        return 1;
+    }
+    std::cout << "RangeAllocator: all checks passed\n";
+    return 0;
+}